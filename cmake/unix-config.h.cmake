@@ -25,10 +25,13 @@
 #cmakedefine HAVE_TERMIOS_H
 #cmakedefine HAVE_NETINET_TCP_H
 #cmakedefine HAVE_PWD_H
+#cmakedefine HAVE_POLL_H
 #cmakedefine HAVE_SYS_WAIT_H
 #cmakedefine HAVE_GETOPT_H
 #cmakedefine HAVE_STDINT_H
 #cmakedefine HAVE_GRP_H
+#cmakedefine HAVE_SYS_EPOLL_H
+#cmakedefine HAVE_SYS_SENDFILE_H
 
 
 /* functions */
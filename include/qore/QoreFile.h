@@ -64,6 +64,8 @@ class Queue;
     @see QoreEncoding
  */
 class QoreFile {
+   friend struct qore_qf_private;
+
 protected:
    //! private implementation
    struct qore_qf_private *priv;
@@ -556,6 +558,21 @@ public:
    //! get file descriptor
    DLLEXPORT int getFD() const;
 
+   //! sets the size of the internal read buffer used for line and character reads; 0 = unbuffered
+   /** any data already buffered is discarded and the file position is reset to the logical read position
+       @param size the new size of the read buffer in bytes; 0 disables read buffering
+       @param xsink if an error occurs, the Qore-language exception info will be added here
+       @return 0 for OK, -1 for error (exception raised)
+
+       @since %Qore 0.8.12
+   */
+   DLLEXPORT int setReadBufferSize(qore_size_t size, ExceptionSink* xsink);
+
+   //! returns the size of the internal read buffer; 0 = unbuffered
+   /** @since %Qore 0.8.12
+    */
+   DLLEXPORT qore_size_t getReadBufferSize() const;
+
    //! returns true if the file is open, false if not
    DLLEXPORT bool isOpen() const;
 
@@ -36,7 +36,6 @@
 #include <qore/AbstractQoreNode.h>
 #include <qore/common.h>
 
-class HashMember;
 class LocalVar;
 
 //! This is the hash or associative list container type in Qore, dynamically allocated only, reference counted
@@ -266,6 +265,17 @@ public:
     */
    DLLEXPORT QoreHashNode* copy() const;
 
+   //! returns a new hash with the same keys in the same order as the current hash but with no values
+   /** the new hash shares the key table of the current hash until keys are added to or removed from either
+       hash, so this is an efficient way to create many hashes with the same keys (for example rows of a query
+       result); assign values to the new hash with HashAssignmentHelper or setKeyValue()
+
+       @return a new hash with the same keys as the current hash and no values
+
+       @since Qore 0.8.12
+    */
+   DLLEXPORT QoreHashNode* copyKeys() const;
+
    //! returns a pointer to a pointer of the value of the key so the value may be set or changed externally
    /** Converts "key" to the default character encoding (QCS_DEFAULT) if necessary.
        An exception could be thrown if the character encoding conversion fails.
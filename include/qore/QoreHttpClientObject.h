@@ -42,6 +42,8 @@
 
 #define HTTPCLIENT_DEFAULT_MAX_REDIRECTS 5         //!< maximum number of HTTP redirects allowed
 
+#define HTTPCLIENT_DEFAULT_POOL_IDLE_TIMEOUT 60000 //!< the default time pooled connections can stay idle before being closed (60,000 ms = 1m)
+
 class Queue;
 
 //! provides a way to communicate with HTTP servers using Qore data structures
@@ -319,6 +321,14 @@ public:
    //! returns the value of the TCP_NODELAY flag on the object
    DLLEXPORT bool getNoDelay() const;
 
+   //! sets the flag that determines if compressed message bodies are decompressed before being passed to receive callbacks
+   /** @param dec if true, message bodies with a supported Content-Encoding are decompressed as they are received and passed to receive callbacks as strings
+    */
+   DLLEXPORT void setDecompressRecvCallback(bool dec);
+
+   //! returns the flag that determines if compressed message bodies are decompressed before being passed to receive callbacks
+   DLLEXPORT bool getDecompressRecvCallback() const;
+
    //! returns the connection status of the object
    DLLEXPORT bool isConnected() const;
 
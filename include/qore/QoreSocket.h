@@ -58,6 +58,7 @@
 #define QSE_IN_OP    -5 //!< in another operation (socket call made in socket callback)
 
 class Queue;
+class QoreFile;
 
 //! a helper class for getting socket origination information
 /** objects of this class are used in some QoreSocket functions
@@ -651,6 +652,20 @@ public:
    */
    DLLEXPORT int send(int fd, qore_offset_t size = -1);
 
+   //! sends untranslated data from the current position of an open file
+   /** uses sendfile() to send the data without copying it through userspace for non-SSL connections where available; for SSL connections the data is read and sent in blocks
+
+       @param file the file to send data from; any data already read into the file's read buffer is sent first
+       @param size the number of bytes to send (-1 = send all data until EOF)
+       @param timeout_ms the maximum amount of time the socket can block on a single send as an integer in milliseconds
+       @param xsink if an error occurs, the Qore-language exception information will be added here
+
+       @return the number of bytes sent, negative for error (exception raised)
+
+       @since Qore 0.8.12
+   */
+   DLLEXPORT int64 sendFile(QoreFile& file, int64 size, int timeout_ms, ExceptionSink* xsink);
+
    //! sends a 1-byte binary integer data to a connected socket
    /** The socket must be connected before this call is made.
        @param i the 1-byte integer to send through the socket
@@ -1327,6 +1342,25 @@ public:
    */
    DLLEXPORT int sendHTTPResponse(ExceptionSink* xsink, int code, const char* desc, const char* http_version, const QoreHashNode* headers, const void* data, qore_size_t size, int source, int timeout_ms);
 
+   //! send an HTTP response message on the socket with a message body sent from the current position of an open file
+   /** The socket must be connected before this call is made; the message body is sent with sendfile() where possible
+
+       @param xsink if an error occurs, the Qore-language exception information will be added here
+       @param code the HTTP response code
+       @param desc the text description for the response code
+       @param http_version should be either "1.0" or "1.1"
+       @param headers a hash of headers to send (key: value)
+       @param file the file providing the message body
+       @param size the length of the message body; if negative, all data up to the end of the file is sent (the file must be a regular file in this case)
+       @param source the event source code for socket events
+       @param timeout_ms the maximum amount of time the socket can block on a single send as an integer in milliseconds
+
+       @return 0 for OK, not 0 for error
+
+       @since Qore 0.8.12
+   */
+   DLLEXPORT int sendHTTPResponse(ExceptionSink* xsink, int code, const char* desc, const char* http_version, const QoreHashNode* headers, QoreFile& file, int64 size, int source, int timeout_ms);
+
    //! send an HTTP response message on the socket with a chunked message body using a calback
    /** The socket must be connected before this call is made.
 
@@ -1647,6 +1681,23 @@ public:
    //! returns true if a HTTP header was read indicating chunked transfer encoding, but no chunked body has been read
    DLLEXPORT bool pendingHttpChunkedBody() const;
 
+   //! sets the size of the buffer used for buffered reads
+   /** by default the buffer starts at 4KB and is grown automatically while reads keep filling it
+
+       @param size the size of the read buffer in bytes; if 0, the default size is restored and the buffer is again grown automatically; otherwise the buffer is not grown automatically
+       @param xsink if an error occurs, the Qore-language exception information will be added here
+
+       @return 0 for OK, -1 for error (the size exceeds the maximum buffer size or the buffer could not be allocated)
+
+       @since Qore 0.8.12
+   */
+   DLLEXPORT int setReadBufferSize(qore_size_t size, ExceptionSink* xsink);
+
+   //! returns the current size of the buffer used for buffered reads
+   /** @since Qore 0.8.12
+   */
+   DLLEXPORT qore_size_t getReadBufferSize() const;
+
    DLLLOCAL static void doException(int rc, const char* meth, int timeout_ms, ExceptionSink* xsink);
 
    //! sets the event queue (not part of the library's pubilc API), must be already referenced before call
@@ -98,6 +98,8 @@ public:
    DLLEXPORT int send(const BinaryNode* b, int timeout_ms, ExceptionSink* xsink);
    // send from a file descriptor
    DLLEXPORT int send(int fd, int size = -1);
+   // send data from the current position of a file; returns the number of bytes sent
+   DLLEXPORT int64 sendFile(QoreFile& file, int64 size, int timeout_ms, ExceptionSink* xsink);
    // send bytes and convert to network order
    DLLEXPORT int sendi1(char b, int timeout_ms, ExceptionSink* xsink);
    DLLEXPORT int sendi2(short b, int timeout_ms, ExceptionSink* xsink);
@@ -136,6 +138,7 @@ public:
 
    // send HTTP response
    DLLEXPORT int sendHTTPResponse(ExceptionSink* xsink, int code, const char* desc, const char* http_version, const QoreHashNode* headers, const void* ptr, int size, int source, int timeout_ms);
+   DLLEXPORT int sendHTTPResponse(ExceptionSink* xsink, int code, const char* desc, const char* http_version, const QoreHashNode* headers, QoreFile& file, int64 size, int source, int timeout_ms);
    DLLEXPORT int sendHTTPResponseWithCallback(ExceptionSink* xsink, int code, const char *desc, const char *http_version, const QoreHashNode *headers, const ResolvedCallReferenceNode& send_callback, int source, int timeout_ms);
    DLLEXPORT int sendHTTPResponseWithCallback(ExceptionSink* xsink, int code, const char *desc, const char *http_version, const QoreHashNode *headers, const ResolvedCallReferenceNode& send_callback, int source, int timeout_ms, bool* aborted);
 
@@ -191,6 +194,8 @@ public:
    DLLEXPORT QoreHashNode* getUsageInfo() const;
    DLLEXPORT void clearStats();
    DLLEXPORT bool pendingHttpChunkedBody() const;
+   DLLEXPORT int setReadBufferSize(qore_size_t size, ExceptionSink* xsink);
+   DLLEXPORT qore_size_t getReadBufferSize() const;
 };
 
 #endif // _QORE_QORE_SOCKET_OBJECT_H
@@ -250,6 +250,166 @@ public:
 
 class AbstractQoreFunctionVariant;
 
+// number of entries in a call-site variant cache
+#define QORE_VARIANT_CACHE_SIZE 4
+// maximum number of arguments for calls whose variants are cached
+#define QORE_VARIANT_CACHE_MAX_ARGS 8
+// number of misses after which a call site is treated as megamorphic and no longer cached
+#define QORE_VARIANT_CACHE_MAX_MISSES 32
+
+// global generation counter for call-site method caches; incremented when methods are added to classes that have
+// already been committed
+DLLLOCAL extern unsigned qore_method_gen;
+
+// invalidates all call-site method caches
+DLLLOCAL void qore_method_cache_invalidate();
+
+// returns a new unique serial number; used as the generation of functions and the serial number of classes in call-site
+// cache keys, so keys are never matched by a function or class allocated at the address of a deleted one
+DLLLOCAL unsigned qore_cache_serial_next();
+
+// per-call-site inline cache for variants that could not be resolved at parse time
+/* entries are keyed by the function and its generation, and the runtime argument types (and class serial numbers for
+   object arguments); entries are stored in the cache itself and each slot has a sequence number that is odd while
+   the slot is being written, so lookups are made without locking by checking that the sequence number of the slot is
+   unchanged after the entry has been compared
+*/
+class VariantCache {
+protected:
+   struct Entry {
+      const QoreFunction* func;
+      const AbstractQoreFunctionVariant* variant;
+      int64 po;
+      unsigned gen;
+      // serial number of the runtime class context; only set if there is an object argument, as private inheritance
+      // affects matching
+      unsigned ctx;
+      unsigned nargs;
+      qore_type_t types[QORE_VARIANT_CACHE_MAX_ARGS];
+      // class serial numbers of object arguments
+      unsigned classes[QORE_VARIANT_CACHE_MAX_ARGS];
+
+      // returns true if the entry has an object argument
+      DLLLOCAL bool set(const QoreFunction* f, const QoreValueList* args, unsigned n);
+
+      DLLLOCAL bool operator==(const Entry& e) const {
+         if (func != e.func || nargs != e.nargs || gen != e.gen || po != e.po || ctx != e.ctx)
+            return false;
+         for (unsigned i = 0; i < nargs; ++i)
+            if (types[i] != e.types[i] || classes[i] != e.classes[i])
+               return false;
+         return true;
+      }
+   };
+
+   Entry entry[QORE_VARIANT_CACHE_SIZE];
+   // slot sequence numbers: 0 = never written, odd = being written
+   unsigned seq[QORE_VARIANT_CACHE_SIZE];
+   unsigned next;
+   unsigned misses;
+   // the function and its generation when the call site became megamorphic; if the function changes, then the call
+   // site is cached again
+   const QoreFunction* mfunc;
+   unsigned mgen;
+   QoreThreadLock l;
+
+   DLLLOCAL void init() {
+      next = misses = mgen = 0;
+      mfunc = 0;
+      for (unsigned i = 0; i < QORE_VARIANT_CACHE_SIZE; ++i)
+         seq[i] = 0;
+   }
+
+   // writes the given slot; must be called with the lock held
+   DLLLOCAL void store(unsigned i, const Entry& e);
+
+   // clears all entries; must be called with the lock held
+   DLLLOCAL void clear();
+
+   DLLLOCAL void add(const Entry& e);
+
+public:
+   DLLLOCAL VariantCache() {
+      init();
+   }
+
+   // the cache is not copied
+   DLLLOCAL VariantCache(const VariantCache& old) {
+      init();
+   }
+
+   // finds a variant with the cache, calls QoreFunction::findVariant() on a miss
+   DLLLOCAL const AbstractQoreFunctionVariant* findVariant(const QoreFunction* func, const QoreValueList* args, ExceptionSink* xsink);
+};
+
+// number of runtime classes remembered by a call-site method cache
+#define QORE_METHOD_CACHE_SIZE 4
+
+// per-call-site inline cache for methods called on objects whose class does not match the class resolved at parse time
+/* entries map the serial number of the runtime class of the object to the method found for the call; like
+   VariantCache entries, they are stored in the cache itself and read without locking using per-slot sequence numbers
+*/
+class MethodCache {
+protected:
+   struct Entry {
+      const QoreMethod* method;
+      unsigned serial;
+      unsigned gen;
+      // true if the method was found in a privately-inherited class
+      bool priv_flag;
+   };
+
+   Entry entry[QORE_METHOD_CACHE_SIZE];
+   // slot sequence numbers: 0 = never written, odd = being written
+   unsigned seq[QORE_METHOD_CACHE_SIZE];
+   unsigned next;
+   unsigned misses;
+   // generation of the cached entries
+   unsigned cgen;
+   QoreThreadLock l;
+
+   DLLLOCAL void init() {
+      next = misses = cgen = 0;
+      for (unsigned i = 0; i < QORE_METHOD_CACHE_SIZE; ++i)
+         seq[i] = 0;
+   }
+
+public:
+   DLLLOCAL MethodCache() {
+      init();
+   }
+
+   // the cache is not copied
+   DLLLOCAL MethodCache(const MethodCache& old) {
+      init();
+   }
+
+   // returns the cached method for the given class serial number and generation or 0 if there is no entry
+   DLLLOCAL const QoreMethod* find(unsigned serial, unsigned gen, bool& priv_flag) const {
+      for (unsigned i = 0; i < QORE_METHOD_CACHE_SIZE; ++i) {
+         unsigned s = qore_atomic_load_acquire(&seq[i]);
+         if (!s)
+            break;
+         if (s & 1)
+            continue;
+         const Entry& e = entry[i];
+         bool match = (e.serial == serial && e.gen == gen);
+         const QoreMethod* m = e.method;
+         bool pf = e.priv_flag;
+         qore_atomic_fence_acquire();
+         if (match && qore_atomic_load(&seq[i]) == s) {
+            thread_variant_cache_hit();
+            priv_flag = pf;
+            return m;
+         }
+      }
+      return 0;
+   }
+
+   // caches the method found for the given class serial number; "gen" must be read before the method is searched
+   DLLLOCAL void add(unsigned serial, const QoreMethod* m, bool priv_flag, unsigned gen);
+};
+
 class CodeEvaluationHelper {
 protected:
    qore_call_t ct;
@@ -264,7 +424,8 @@ protected:
 
 public:
    // saves current program location in case there's an exception
-   DLLLOCAL CodeEvaluationHelper(ExceptionSink* n_xsink, const QoreFunction* func, const AbstractQoreFunctionVariant*& variant, const char* n_name, const QoreListNode* args = 0, const char* n_class_name = 0, qore_call_t n_ct = CT_UNUSED, bool is_copy = false);
+   // if "vc" is not 0 and the variant is not known, then the variant is found with the given call-site cache
+   DLLLOCAL CodeEvaluationHelper(ExceptionSink* n_xsink, const QoreFunction* func, const AbstractQoreFunctionVariant*& variant, const char* n_name, const QoreListNode* args = 0, const char* n_class_name = 0, qore_call_t n_ct = CT_UNUSED, bool is_copy = false, VariantCache* vc = 0);
 
    DLLLOCAL ~CodeEvaluationHelper();
 
@@ -551,6 +712,9 @@ protected:
    // list of inherited methods for variant matching; the first pointer is always a pointer to "this"
    ilist_t ilist;
 
+   // unique generation; changed every time the variant or inheritance lists are changed
+   unsigned gen;
+
    // if true means all variants have the same return value
    bool same_return_type, parse_same_return_type;
    int64 unique_functionality;
@@ -661,6 +825,12 @@ protected:
       }
 
       vlist.push_back(variant);
+      variantsChanged();
+   }
+
+   // called when the variant or inheritance lists have been changed
+   DLLLOCAL void variantsChanged() {
+      qore_atomic_store_release(&gen, qore_cache_serial_next());
    }
 
    DLLLOCAL virtual ~QoreFunction() {
@@ -675,6 +845,7 @@ public:
         nn_unique_flags(QC_NO_FLAGS), nn_count(0), parse_rt_done(true),
         parse_init_done(true), has_user(false), has_builtin(false), has_mod_pub(false), inject(false),
         nn_uniqueReturnType(0) {
+      gen = qore_cache_serial_next();
       ilist.push_back(this);
       //printd(5, "QoreFunction::QoreFunction() this: %p %s\n", this, name.c_str());
    }
@@ -721,6 +892,8 @@ public:
       assert(!old.ilist.empty());
       assert(old.ilist.front() == &old);
 
+      gen = qore_cache_serial_next();
+
       // resolve initial ilist entry to this function
       ilist.push_back(this);
 
@@ -804,6 +977,7 @@ public:
 
    DLLLOCAL void addAncestor(QoreFunction* ancestor) {
       ilist.push_back(ancestor);
+      variantsChanged();
    }
 
    DLLLOCAL void addNewAncestor(QoreFunction* ancestor) {
@@ -811,11 +985,26 @@ public:
          if (*i == ancestor)
             return;
       ilist.push_back(ancestor);
+      variantsChanged();
    }
 
    // resolves all types in signatures and return types in pending variants; called during the "parseInit" phase
    DLLLOCAL void resolvePendingSignatures();
 
+   // returns the generation of the variants that can be matched including inherited variants
+   /* generations are unique and increasing, so the highest generation in the inheritance list changes whenever
+      the function or any function it inherits is changed
+   */
+   DLLLOCAL unsigned getVariantGeneration() const {
+      unsigned rv = 0;
+      for (ilist_t::const_iterator i = ilist.begin(), e = ilist.end(); i != e; ++i) {
+         unsigned g = qore_atomic_load_acquire(&(*i)->gen);
+         if (g > rv)
+            rv = g;
+      }
+      return rv;
+   }
+
    DLLLOCAL AbstractFunctionSignature* getUniqueSignature() const {
       return vlist.singular() ? first()->getSignature() : 0;
    }
@@ -871,7 +1060,8 @@ public:
    }
 
    // if the variant was identified at parse time, then variant will not be NULL, otherwise if NULL then it is identified at run time
-   DLLLOCAL virtual QoreValue evalFunction(const AbstractQoreFunctionVariant* variant, const QoreListNode* args, QoreProgram* pgm, ExceptionSink* xsink) const;
+   // if "vc" is not 0, then it is used to find the variant if it was not identified at parse time
+   DLLLOCAL virtual QoreValue evalFunction(const AbstractQoreFunctionVariant* variant, const QoreListNode* args, QoreProgram* pgm, ExceptionSink* xsink, VariantCache* vc = 0) const;
 
    // finds a variant and checks variant capabilities against current program parse options and executes the variant
    DLLLOCAL QoreValue evalDynamic(const QoreListNode* args, ExceptionSink* xsink) const;
@@ -35,24 +35,50 @@
 
 #include <qore/Qore.h>
 
+// returns the call-site cache stored in the given pointer; the cache is allocated when it's first used, so only call
+// sites that are resolved at runtime have a cache
+template <typename T>
+DLLLOCAL T* get_call_site_cache(T** p) {
+   T* c = qore_atomic_load_acquire(p);
+   if (c)
+      return c;
+
+   T* nc = new T;
+   // the cache must be initialized before it can be seen by other threads
+   qore_atomic_fence_release();
+   if (qore_atomic_cas(p, c, nc))
+      return nc;
+   // another thread has already allocated the cache
+   delete nc;
+   qore_atomic_fence_acquire();
+   return c;
+}
+
 class FunctionCallBase {
 protected:
    QoreListNode* args;
    const AbstractQoreFunctionVariant* variant;
+   // call-site cache for variants that could not be resolved at parse time; allocated on demand
+   mutable VariantCache* vcache;
+
+   DLLLOCAL VariantCache* getVariantCache() const {
+      return get_call_site_cache(&vcache);
+   }
 
 public:
-   DLLLOCAL FunctionCallBase(QoreListNode* n_args) : args(n_args), variant(0) {
+   DLLLOCAL FunctionCallBase(QoreListNode* n_args) : args(n_args), variant(0), vcache(0) {
    }
 
-   DLLLOCAL FunctionCallBase(const FunctionCallBase &old) : args(old.args ? old.args->listRefSelf() : 0), variant(old.variant) {
+   DLLLOCAL FunctionCallBase(const FunctionCallBase &old) : args(old.args ? old.args->listRefSelf() : 0), variant(old.variant), vcache(0) {
    }
 
-   DLLLOCAL FunctionCallBase(const FunctionCallBase &old, QoreListNode* n_args) : args(n_args), variant(old.variant) {
+   DLLLOCAL FunctionCallBase(const FunctionCallBase &old, QoreListNode* n_args) : args(n_args), variant(old.variant), vcache(0) {
    }
 
    DLLLOCAL ~FunctionCallBase() {
       if (args)
 	 args->deref(0);
+      delete vcache;
    }
    DLLLOCAL const QoreListNode* getArgs() const { return args; }
    DLLLOCAL int parseArgsVariant(const QoreProgramLocation& loc, LocalVar* oflag, int pflag, QoreFunction* func, const QoreTypeInfo*& returnTypeInfo);
@@ -223,6 +249,12 @@ protected:
    // is needed
    const QoreClass* qc;
    const QoreMethod* method;
+   // call-site cache for methods found at runtime for objects of other classes; allocated on demand
+   mutable MethodCache* mcache;
+
+   DLLLOCAL MethodCache* getMethodCache() const {
+      return get_call_site_cache(&mcache);
+   }
 
    DLLLOCAL virtual AbstractQoreNode* parseInitImpl(LocalVar* oflag, int pflag, int& lvids, const QoreTypeInfo*& typeInfo) = 0;
    DLLLOCAL virtual const QoreTypeInfo* getTypeInfo() const {
@@ -230,13 +262,17 @@ protected:
    }
 
 public:
-   DLLLOCAL AbstractMethodCallNode(qore_type_t t, QoreListNode* n_args, const QoreClass* n_qc = 0, const QoreMethod* m = 0) : AbstractFunctionCallNode(t, n_args), qc(n_qc), method(m) {
+   DLLLOCAL AbstractMethodCallNode(qore_type_t t, QoreListNode* n_args, const QoreClass* n_qc = 0, const QoreMethod* m = 0) : AbstractFunctionCallNode(t, n_args), qc(n_qc), method(m), mcache(0) {
+   }
+
+   DLLLOCAL AbstractMethodCallNode(const AbstractMethodCallNode &old) : AbstractFunctionCallNode(old), qc(old.qc), method(old.method), mcache(0) {
    }
 
-   DLLLOCAL AbstractMethodCallNode(const AbstractMethodCallNode &old) : AbstractFunctionCallNode(old), qc(old.qc), method(old.method) {
+   DLLLOCAL AbstractMethodCallNode(const AbstractMethodCallNode &old, QoreListNode* n_args) : AbstractFunctionCallNode(old, n_args), qc(old.qc), method(old.method), mcache(0) {
    }
 
-   DLLLOCAL AbstractMethodCallNode(const AbstractMethodCallNode &old, QoreListNode* n_args) : AbstractFunctionCallNode(old, n_args), qc(old.qc), method(old.method) {
+   DLLLOCAL virtual ~AbstractMethodCallNode() {
+      delete mcache;
    }
 
    DLLLOCAL QoreValue exec(QoreObject* o, const char* cstr, ExceptionSink* xsink) const;
@@ -247,6 +247,11 @@ private:
       return thread_find_lvar(name.c_str());
    }
 
+   // uses the slot hint of the caller's access site
+   DLLLOCAL LocalVarValue* get_var(int& hint) const {
+      return thread_find_lvar(name.c_str(), hint);
+   }
+
 public:
    DLLLOCAL LocalVar(const char* n_name, const QoreTypeInfo* ti) : name(n_name), closure_use(false), parse_assigned(false), typeInfo(ti) {
    }
@@ -324,6 +329,16 @@ public:
       return val->evalValue(needs_deref, xsink);
    }
 
+   DLLLOCAL QoreValue evalValue(bool& needs_deref, ExceptionSink* xsink, int& hint) const {
+      if (!closure_use) {
+         LocalVarValue* val = get_var(hint);
+         return val->evalValue(needs_deref, xsink);
+      }
+
+      ClosureVarValue* val = thread_find_closure_var(name.c_str());
+      return val->evalValue(needs_deref, xsink);
+   }
+
    DLLLOCAL const char* getName() const {
       return name.c_str();
    }
@@ -344,6 +359,10 @@ public:
       return !closure_use ? get_var()->isRef() : thread_find_closure_var(name.c_str())->isRef();
    }
 
+   DLLLOCAL bool isRef(int& hint) const {
+      return !closure_use ? get_var(hint)->isRef() : thread_find_closure_var(name.c_str())->isRef();
+   }
+
    DLLLOCAL int getLValue(LValueHelper& lvh, bool for_remove) const {
       //printd(5, "LocalVar::getLValue() this: %p '%s' for_remove: %d closure_use: %d\n", this, getName(), for_remove, closure_use);
       if (!closure_use) {
@@ -354,6 +373,15 @@ public:
       return thread_find_closure_var(name.c_str())->getLValue(lvh, for_remove);
    }
 
+   DLLLOCAL int getLValue(LValueHelper& lvh, bool for_remove, int& hint) const {
+      if (!closure_use) {
+         lvh.setTypeInfo(typeInfo);
+         return get_var(hint)->getLValue(lvh, for_remove);
+      }
+
+      return thread_find_closure_var(name.c_str())->getLValue(lvh, for_remove);
+   }
+
    DLLLOCAL void remove(LValueRemoveHelper& lvrh) {
       if (!closure_use)
          return get_var()->remove(lvrh, typeInfo);
@@ -361,6 +389,13 @@ public:
       return thread_find_closure_var(name.c_str())->remove(lvrh);
    }
 
+   DLLLOCAL void remove(LValueRemoveHelper& lvrh, int& hint) {
+      if (!closure_use)
+         return get_var(hint)->remove(lvrh, typeInfo);
+
+      return thread_find_closure_var(name.c_str())->remove(lvrh);
+   }
+
    DLLLOCAL const QoreTypeInfo* getTypeInfo() const {
       return typeInfo;
    }
@@ -0,0 +1,474 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+  QC_ColumnSet.h
+
+  Qore Programming Language
+
+  Copyright (C) 2003 - 2015 David Nichols
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+  DEALINGS IN THE SOFTWARE.
+
+  Note that the Qore library is released under a choice of three open-source
+  licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+  information.
+*/
+
+#ifndef _QORE_QC_COLUMNSET_H
+#define _QORE_QC_COLUMNSET_H
+
+#include <qore/Qore.h>
+#include <qore/QoreRWLock.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+DLLEXPORT extern qore_classid_t CID_COLUMNSET;
+DLLLOCAL extern QoreClass* QC_COLUMNSET;
+DLLEXPORT extern qore_classid_t CID_COLUMNSETITERATOR;
+DLLLOCAL extern QoreClass* QC_COLUMNSETITERATOR;
+
+DLLLOCAL QoreClass* initColumnSetClass(QoreNamespace& ns);
+DLLLOCAL QoreClass* initColumnSetIteratorClass(QoreNamespace& ns);
+
+// the values of one column; int, float, bool, date and string values are stored unboxed, other values as nodes
+// column buffers are shared by ColumnSet copies and slices and are never modified while shared
+class QoreColumn : public QoreReferenceCounter {
+public:
+   enum col_type_e {
+      CT_NONE = 0,      // no type yet; all values are null
+      CT_INT,
+      CT_FLOAT,
+      CT_BOOL,
+      CT_DATE,          // absolute dates as microseconds since the epoch
+      CT_STRING,        // strings in one encoding stored back to back in the arena
+      CT_ANY,           // mixed or other types stored as nodes
+   };
+
+   col_type_e type;
+   // number of values in the column
+   size_t len;
+   // CT_INT and CT_DATE values
+   std::vector<int64> ints;
+   // CT_FLOAT values
+   std::vector<double> floats;
+   // CT_BOOL values
+   std::vector<bool> bools;
+   // CT_STRING values: the string data and len + 1 offsets of each value in the arena
+   std::string arena;
+   std::vector<size_t> offsets;
+   const QoreEncoding* enc;
+   // CT_ANY values; holds a reference for each value
+   std::vector<AbstractQoreNode*> nodes;
+   // null bitmap; a set bit marks a null value; only allocated up to the last null value
+   std::vector<unsigned char> nulls;
+
+   DLLLOCAL QoreColumn() : type(CT_NONE), len(0), enc(0) {
+   }
+
+   DLLLOCAL void deref(ExceptionSink* xsink) {
+      if (ROdereference()) {
+         for (std::vector<AbstractQoreNode*>::iterator i = nodes.begin(), e = nodes.end(); i != e; ++i) {
+            if (*i)
+               (*i)->deref(xsink);
+         }
+         delete this;
+      }
+   }
+
+   DLLLOCAL static col_type_e getType(const AbstractQoreNode* n) {
+      switch (get_node_type(n)) {
+         case NT_INT: return CT_INT;
+         case NT_FLOAT: return CT_FLOAT;
+         case NT_BOOLEAN: return CT_BOOL;
+         case NT_DATE: return reinterpret_cast<const DateTimeNode*>(n)->isAbsolute() ? CT_DATE : CT_ANY;
+         case NT_STRING: return CT_STRING;
+      }
+      return CT_ANY;
+   }
+
+   DLLLOCAL const char* getTypeName() const {
+      switch (type) {
+         case CT_NONE: return "nothing";
+         case CT_INT: return "int";
+         case CT_FLOAT: return "float";
+         case CT_BOOL: return "bool";
+         case CT_DATE: return "date";
+         case CT_STRING: return "string";
+         case CT_ANY: break;
+      }
+      return "any";
+   }
+
+   DLLLOCAL bool isNull(size_t i) const {
+      return (i >> 3) < nulls.size() && (nulls[i >> 3] & (1 << (i & 7)));
+   }
+
+   DLLLOCAL void setNull(size_t i) {
+      if (nulls.size() <= (i >> 3))
+         nulls.resize((i >> 3) + 1, 0);
+      nulls[i >> 3] |= (1 << (i & 7));
+   }
+
+   // appends a null value
+   DLLLOCAL void addNull() {
+      switch (type) {
+         case CT_NONE: break;
+         case CT_INT:
+         case CT_DATE: ints.push_back(0); break;
+         case CT_FLOAT: floats.push_back(0); break;
+         case CT_BOOL: bools.push_back(false); break;
+         case CT_STRING: offsets.push_back(arena.size()); break;
+         case CT_ANY: nodes.push_back(0); break;
+      }
+      setNull(len++);
+   }
+
+   // appends a value; NOTHING and NULL are stored as null values
+   DLLLOCAL void add(const AbstractQoreNode* n) {
+      if (is_nothing(n) || is_null(n)) {
+         addNull();
+         return;
+      }
+
+      col_type_e t = getType(n);
+      // strings in another encoding are stored as nodes
+      if (t == CT_STRING && type == CT_STRING && reinterpret_cast<const QoreStringNode*>(n)->getEncoding() != enc)
+         t = CT_ANY;
+      if (t != type) {
+         if (type == CT_NONE)
+            setType(t, n);
+         else if (type != CT_ANY)
+            toAny();
+      }
+
+      switch (type) {
+         case CT_INT: ints.push_back(reinterpret_cast<const QoreBigIntNode*>(n)->val); break;
+         case CT_FLOAT: floats.push_back(reinterpret_cast<const QoreFloatNode*>(n)->f); break;
+         case CT_BOOL: bools.push_back(reinterpret_cast<const QoreBoolNode*>(n)->getValue()); break;
+         case CT_DATE: {
+            const DateTimeNode* d = reinterpret_cast<const DateTimeNode*>(n);
+            ints.push_back(d->getEpochSecondsUTC() * 1000000 + d->getMicrosecond());
+            break;
+         }
+         case CT_STRING: {
+            const QoreStringNode* str = reinterpret_cast<const QoreStringNode*>(n);
+            arena.append(str->getBuffer(), str->strlen());
+            offsets.push_back(arena.size());
+            break;
+         }
+         case CT_ANY: nodes.push_back(n->refSelf()); break;
+         case CT_NONE: assert(false); break;
+      }
+      ++len;
+   }
+
+   // returns the value at the given position; the caller owns the reference returned
+   DLLLOCAL AbstractQoreNode* get(size_t i) const {
+      assert(i < len);
+      if (isNull(i))
+         return 0;
+
+      switch (type) {
+         case CT_INT: return new QoreBigIntNode(ints[i]);
+         case CT_FLOAT: return new QoreFloatNode(floats[i]);
+         case CT_BOOL: return get_bool_node(bools[i]);
+         case CT_DATE: {
+            int64 secs = ints[i] / 1000000;
+            int us = (int)(ints[i] % 1000000);
+            if (us < 0) {
+               us += 1000000;
+               --secs;
+            }
+            return DateTimeNode::makeAbsolute(currentTZ(), secs, us);
+         }
+         case CT_STRING: return new QoreStringNode(arena.data() + offsets[i], offsets[i + 1] - offsets[i], enc);
+         case CT_ANY: return nodes[i] ? nodes[i]->refSelf() : 0;
+         case CT_NONE: break;
+      }
+      return 0;
+   }
+
+   // returns a new unshared buffer with a copy of the given range of values
+   DLLLOCAL QoreColumn* copy(size_t start, size_t n) const {
+      assert(start + n <= len);
+      QoreColumn* c = new QoreColumn;
+      c->type = type;
+      c->enc = enc;
+      c->len = n;
+
+      switch (type) {
+         case CT_INT:
+         case CT_DATE: c->ints.assign(ints.begin() + start, ints.begin() + start + n); break;
+         case CT_FLOAT: c->floats.assign(floats.begin() + start, floats.begin() + start + n); break;
+         case CT_BOOL: c->bools.assign(bools.begin() + start, bools.begin() + start + n); break;
+         case CT_STRING: {
+            size_t b = offsets[start];
+            c->arena.assign(arena, b, offsets[start + n] - b);
+            c->offsets.reserve(n + 1);
+            for (size_t i = start, e = start + n; i <= e; ++i)
+               c->offsets.push_back(offsets[i] - b);
+            break;
+         }
+         case CT_ANY: {
+            c->nodes.reserve(n);
+            for (size_t i = start, e = start + n; i < e; ++i) {
+               if (nodes[i])
+                  nodes[i]->ref();
+               c->nodes.push_back(nodes[i]);
+            }
+            break;
+         }
+         case CT_NONE: break;
+      }
+
+      for (size_t i = 0; i < n; ++i) {
+         if (isNull(start + i))
+            c->setNull(i);
+      }
+      return c;
+   }
+
+protected:
+   DLLLOCAL ~QoreColumn() {
+   }
+
+   // sets the type of a column with only null values
+   DLLLOCAL void setType(col_type_e t, const AbstractQoreNode* n) {
+      assert(type == CT_NONE);
+      type = t;
+      switch (type) {
+         case CT_INT:
+         case CT_DATE: ints.resize(len, 0); break;
+         case CT_FLOAT: floats.resize(len, 0); break;
+         case CT_BOOL: bools.resize(len, false); break;
+         case CT_STRING:
+            offsets.resize(len + 1, 0);
+            enc = reinterpret_cast<const QoreStringNode*>(n)->getEncoding();
+            break;
+         case CT_ANY: nodes.resize(len, 0); break;
+         case CT_NONE: break;
+      }
+   }
+
+   // converts the column to a column of nodes when a value of another type is added
+   DLLLOCAL void toAny() {
+      assert(type != CT_NONE && type != CT_ANY);
+      std::vector<AbstractQoreNode*> nv;
+      nv.reserve(len + 1);
+      for (size_t i = 0; i < len; ++i)
+         nv.push_back(get(i));
+
+      std::vector<int64>().swap(ints);
+      std::vector<double>().swap(floats);
+      std::vector<bool>().swap(bools);
+      std::string().swap(arena);
+      std::vector<size_t>().swap(offsets);
+      nodes.swap(nv);
+      type = CT_ANY;
+   }
+};
+
+// the private data of ColumnSet objects: named columns of the same length
+class QoreColumnSet : public AbstractPrivateData {
+protected:
+   typedef std::vector<std::string> name_vec_t;
+   typedef std::vector<QoreColumn*> col_vec_t;
+   typedef std::map<std::string, size_t> name_map_t;
+
+   // column names in order
+   name_vec_t names;
+   // column buffers in the same order; each holds a reference
+   col_vec_t cols;
+   // maps column names to positions
+   name_map_t nmap;
+   // the rows of the column buffers in this set; buffers may be longer when shared
+   size_t start, len;
+   // a hash with a key for each column; row hashes are created with its key table
+   QoreHashNode* row_keys;
+   mutable QoreRWLock rwl;
+
+   // creates a set sharing the given range of rows of another set's buffers; the other set must be locked
+   DLLLOCAL QoreColumnSet(const QoreColumnSet& old, size_t s, size_t l);
+
+   DLLLOCAL virtual ~QoreColumnSet() {
+      assert(cols.empty());
+   }
+
+   // returns the position of the column or -1 if it does not exist (exception raised)
+   DLLLOCAL qore_offset_t findColumn(const char* name, ExceptionSink* xsink) const;
+
+   // creates a new column with null values for all existing rows and returns its position
+   DLLLOCAL size_t addColumnIntern(const char* name);
+
+   // makes sure all column buffers are unshared and contain exactly the rows of this set
+   DLLLOCAL void unshareIntern(ExceptionSink* xsink);
+
+   // adds null values to columns that have no value for the last row
+   DLLLOCAL void fillIntern();
+
+   DLLLOCAL int addIntern(const QoreHashNode* row);
+   DLLLOCAL int addIntern(const QoreListNode* row, ExceptionSink* xsink);
+
+   DLLLOCAL QoreHashNode* getRowIntern(size_t row) const;
+
+   // converts a range given by the user to a range of rows in this set
+   DLLLOCAL void getRange(int64 offset, int64 length, size_t& s, size_t& l) const;
+
+public:
+   DLLLOCAL QoreColumnSet() : start(0), len(0), row_keys(0) {
+   }
+
+   using AbstractPrivateData::deref;
+   DLLLOCAL virtual void deref(ExceptionSink* xsink);
+
+   // returns a set sharing the column buffers of this set
+   DLLLOCAL QoreColumnSet* slice(int64 offset, int64 length = -1) const;
+
+   DLLLOCAL size_t size() const {
+      QoreAutoRWReadLocker al(rwl);
+      return len;
+   }
+
+   DLLLOCAL QoreListNode* getColumnNames() const;
+   DLLLOCAL QoreStringNode* getColumnType(const char* col, ExceptionSink* xsink) const;
+   DLLLOCAL QoreHashNode* getColumnTypes() const;
+
+   DLLLOCAL int add(const QoreHashNode* row, ExceptionSink* xsink);
+   DLLLOCAL int add(const QoreListNode* row, ExceptionSink* xsink);
+   DLLLOCAL int addRows(const QoreListNode* rows, ExceptionSink* xsink);
+   DLLLOCAL int addColumns(const QoreHashNode* h, ExceptionSink* xsink);
+
+   DLLLOCAL AbstractQoreNode* getValue(const char* col, int64 row, ExceptionSink* xsink) const;
+   DLLLOCAL bool isNull(const char* col, int64 row, ExceptionSink* xsink) const;
+   DLLLOCAL QoreHashNode* getRow(int64 row) const;
+   DLLLOCAL QoreListNode* getRowList(int64 row, const QoreListNode* cl, ExceptionSink* xsink) const;
+   DLLLOCAL QoreListNode* getColumn(const char* col, ExceptionSink* xsink) const;
+   DLLLOCAL QoreHashNode* getColumns(int64 offset, int64 length) const;
+   DLLLOCAL QoreListNode* getRows(int64 offset, int64 length) const;
+};
+
+// the private data of ColumnSetIterator objects; iterates the rows the set had when the iterator was created
+class QoreColumnSetIterator : public QoreIteratorBase {
+protected:
+   QoreColumnSet* cs;
+   qore_offset_t i, limit;
+
+   DLLLOCAL virtual ~QoreColumnSetIterator() {
+   }
+
+   DLLLOCAL int checkPtr(ExceptionSink* xsink) const {
+      if (i < 0) {
+         xsink->raiseException("ITERATOR-ERROR", "the %s is not pointing at a valid element; make sure %s::next() returns True before calling this method", getName(), getName());
+         return -1;
+      }
+      return 0;
+   }
+
+public:
+   DLLLOCAL QoreColumnSetIterator(QoreColumnSet* n_cs) : cs(n_cs), i(-1), limit((qore_offset_t)n_cs->size()) {
+      cs->ref();
+   }
+
+   DLLLOCAL QoreColumnSetIterator(const QoreColumnSetIterator& old) : cs(old.cs), i(old.i), limit(old.limit) {
+      cs->ref();
+   }
+
+   using AbstractPrivateData::deref;
+   DLLLOCAL virtual void deref(ExceptionSink* xsink) {
+      if (ROdereference()) {
+         cs->deref(xsink);
+         delete this;
+      }
+   }
+
+   DLLLOCAL void reset() {
+      i = -1;
+   }
+
+   DLLLOCAL bool next() {
+      if (++i == limit) {
+         i = -1;
+         return false; // finished
+      }
+      return true;
+   }
+
+   DLLLOCAL bool prev() {
+      if (!limit)
+         return false; // empty
+      if (i == -1) {
+         i = limit - 1;
+         return true;
+      }
+      --i;
+      return i >= 0;
+   }
+
+   DLLLOCAL bool empty() const {
+      return !limit;
+   }
+
+   DLLLOCAL bool valid() const {
+      return i != -1;
+   }
+
+   DLLLOCAL qore_offset_t index() const {
+      return i;
+   }
+
+   DLLLOCAL qore_size_t max() const {
+      return limit;
+   }
+
+   DLLLOCAL bool first() const {
+      return i == 0;
+   }
+
+   DLLLOCAL bool last() const {
+      return i == (limit - 1);
+   }
+
+   DLLLOCAL bool set(qore_offset_t pos) {
+      if (pos < 0 || pos >= limit) {
+         i = -1;
+         return false;
+      }
+      i = pos;
+      return true;
+   }
+
+   DLLLOCAL QoreHashNode* getRow(ExceptionSink* xsink) const {
+      if (checkPtr(xsink))
+         return 0;
+      return cs->getRow(i);
+   }
+
+   DLLLOCAL AbstractQoreNode* getColumnValue(const char* col, ExceptionSink* xsink) const {
+      if (checkPtr(xsink))
+         return 0;
+      return cs->getValue(col, i, xsink);
+   }
+
+   DLLLOCAL virtual const char* getName() const {
+      return "ColumnSetIterator";
+   }
+};
+
+#endif // _QORE_QC_COLUMNSET_H
@@ -0,0 +1,267 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+  QC_Compressor.h
+
+  Qore Programming Language
+
+  Copyright (C) 2003 - 2015 David Nichols
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+  DEALINGS IN THE SOFTWARE.
+
+  Note that the Qore library is released under a choice of three open-source
+  licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+  information.
+*/
+
+#ifndef _QORE_QC_COMPRESSOR_H
+#define _QORE_QC_COMPRESSOR_H
+
+#include <qore/Qore.h>
+#include <qore/QoreSocketObject.h>
+#include <qore/intern/QC_File.h>
+#include <qore/intern/ql_compression.h>
+
+#include <zlib.h>
+#include <bzlib.h>
+
+// size of the output buffer used by compression streams; output is passed to the sink in blocks of at most this size
+#define QORE_COMPRESSION_BUFSIZE (64 * 1024)
+// the maximum amount of input passed to the library in one call; the zlib and bzip2 APIs use 32-bit sizes
+#define QORE_COMPRESSION_MAX_INPUT (1024 * 1024 * 1024)
+
+DLLEXPORT extern qore_classid_t CID_COMPRESSOR;
+DLLLOCAL extern QoreClass* QC_COMPRESSOR;
+DLLEXPORT extern qore_classid_t CID_DECOMPRESSOR;
+DLLLOCAL extern QoreClass* QC_DECOMPRESSOR;
+
+DLLLOCAL QoreClass* initCompressorClass(QoreNamespace& ns);
+DLLLOCAL QoreClass* initDecompressorClass(QoreNamespace& ns);
+
+// receives the output of a compression stream
+class AbstractCompressionSink {
+public:
+   DLLLOCAL virtual ~AbstractCompressionSink() {
+   }
+
+   // returns 0 for OK, -1 for error (meaning that an exception has been raised)
+   DLLLOCAL virtual int write(const void* buf, size_t len, ExceptionSink* xsink) = 0;
+};
+
+// appends output to a binary object
+class BinaryCompressionSink : public AbstractCompressionSink {
+protected:
+   BinaryNode& b;
+
+public:
+   DLLLOCAL BinaryCompressionSink(BinaryNode& n_b) : b(n_b) {
+   }
+
+   DLLLOCAL virtual int write(const void* buf, size_t len, ExceptionSink* xsink) {
+      b.append(buf, len);
+      return 0;
+   }
+};
+
+// appends output to a string
+class StringCompressionSink : public AbstractCompressionSink {
+protected:
+   QoreString& str;
+
+public:
+   DLLLOCAL StringCompressionSink(QoreString& n_str) : str(n_str) {
+   }
+
+   DLLLOCAL virtual int write(const void* buf, size_t len, ExceptionSink* xsink) {
+      str.concat((const char*)buf, len);
+      return 0;
+   }
+};
+
+// writes output to a file
+class FileCompressionSink : public AbstractCompressionSink {
+protected:
+   File& f;
+
+public:
+   int64 written;
+
+   DLLLOCAL FileCompressionSink(File& n_f) : f(n_f), written(0) {
+   }
+
+   DLLLOCAL virtual int write(const void* buf, size_t len, ExceptionSink* xsink) {
+      if (f.write(buf, len, xsink) < 0 || *xsink)
+         return -1;
+      written += len;
+      return 0;
+   }
+};
+
+// sends output on a socket
+class SocketCompressionSink : public AbstractCompressionSink {
+protected:
+   QoreSocketObject& s;
+   int timeout_ms;
+
+public:
+   int64 written;
+
+   DLLLOCAL SocketCompressionSink(QoreSocketObject& n_s, int n_timeout_ms) : s(n_s), timeout_ms(n_timeout_ms), written(0) {
+   }
+
+   DLLLOCAL virtual int write(const void* buf, size_t len, ExceptionSink* xsink) {
+      if (s.send((const char*)buf, (int)len, timeout_ms, xsink) < 0 || *xsink)
+         return -1;
+      written += len;
+      return 0;
+   }
+};
+
+// compression algorithms supported by the Compressor and Decompressor classes
+enum qore_compression_alg_e {
+   QCA_ZLIB = 0,     // zlib format (RFC 1950) as used by compress() and uncompress_to_binary()
+   QCA_DEFLATE = 1,  // raw deflate data (RFC 1951) without a header or trailer
+   QCA_GZIP = 2,     // gzip format (RFC 1952) as used by gzip() and gunzip_to_binary()
+   QCA_BZIP2 = 3,    // bzip2 format as used by bzip2() and bunzip2_to_binary()
+};
+
+// incremental compression or decompression stream
+/* input is processed as it is received and output is passed to the sink through a fixed-size buffer, so the memory
+   used by the stream itself does not depend on the amount of data processed
+*/
+class QoreCompressionStream : public AbstractPrivateData {
+protected:
+   // the library stream; only the one for the algorithm is used
+   z_stream zs;
+   bz_stream bs;
+
+   // output buffer
+   char* buf;
+
+   // serializes access to the stream
+   QoreThreadLock m;
+
+   qore_compression_alg_e alg;
+
+   // true if compressing, false if decompressing
+   bool comp;
+
+   // true if the library stream has been initialized
+   bool init;
+
+   // true if the end of the compressed stream has been reached (when decompressing) or written (when compressing)
+   bool end;
+
+   // true if finish() has been called or if an error occurred
+   bool closed;
+
+   // the total number of bytes of input and output processed
+   int64 total_in, total_out;
+
+   DLLLOCAL virtual ~QoreCompressionStream();
+
+   // initializes the library stream; returns 0 for OK, -1 for error
+   DLLLOCAL int initIntern(int level, ExceptionSink* xsink);
+
+   // releases the library stream
+   DLLLOCAL void endIntern();
+
+   // raises an exception for a zlib error and closes the stream; always returns -1
+   DLLLOCAL int zlibError(int rc, const char* func, ExceptionSink* xsink);
+
+   // raises an exception for a bzip2 error and closes the stream; always returns -1
+   DLLLOCAL int bzip2Error(int rc, const char* func, ExceptionSink* xsink);
+
+   // returns 0 for OK, -1 for error
+   DLLLOCAL int checkOpen(const char* meth, ExceptionSink* xsink) const;
+
+   // passes the data in the output buffer to the sink; returns 0 for OK, -1 for error
+   DLLLOCAL int flushOutput(size_t len, AbstractCompressionSink& sink, ExceptionSink* xsink);
+
+   // compresses the data given; if last is true then the end of the compressed stream is written
+   DLLLOCAL int deflateIntern(const char* p, size_t len, bool last, AbstractCompressionSink& sink, ExceptionSink* xsink);
+   DLLLOCAL int bzCompressIntern(const char* p, size_t len, bool last, AbstractCompressionSink& sink, ExceptionSink* xsink);
+
+   // decompresses the data given
+   DLLLOCAL int inflateIntern(const char* p, size_t len, AbstractCompressionSink& sink, ExceptionSink* xsink);
+   DLLLOCAL int bzDecompressIntern(const char* p, size_t len, AbstractCompressionSink& sink, ExceptionSink* xsink);
+
+   // called when data is received after the end of the compressed stream; returns 0 if a new stream can be started
+   DLLLOCAL int restartIntern(size_t len, ExceptionSink* xsink);
+
+   DLLLOCAL const char* getErrorCode() const {
+      return comp ? "COMPRESSOR-ERROR" : "DECOMPRESSOR-ERROR";
+   }
+
+public:
+   // creates a compression stream; level -1 means the default level for the algorithm
+   DLLLOCAL QoreCompressionStream(qore_compression_alg_e n_alg, bool n_comp, int level, ExceptionSink* xsink);
+
+   // processes the data given; output is passed to the sink; returns 0 for OK, -1 for error
+   DLLLOCAL int update(const void* p, size_t len, AbstractCompressionSink& sink, ExceptionSink* xsink);
+
+   // ends the stream; when compressing, any remaining output is written to the sink; returns 0 for OK, -1 for error
+   /* when decompressing, an exception is raised if the end of the compressed data has not been reached
+    */
+   DLLLOCAL int finish(AbstractCompressionSink& sink, ExceptionSink* xsink);
+
+   // returns true if the end of the compressed stream has been reached
+   DLLLOCAL bool atEnd() const {
+      return end;
+   }
+
+   DLLLOCAL qore_compression_alg_e getAlgorithm() const {
+      return alg;
+   }
+
+   DLLLOCAL int64 getTotalIn() const {
+      return total_in;
+   }
+
+   DLLLOCAL int64 getTotalOut() const {
+      return total_out;
+   }
+
+   // returns the algorithm for the name given or raises an exception
+   DLLLOCAL static int getAlgorithm(const QoreStringNode* name, qore_compression_alg_e& a, const char* err, ExceptionSink* xsink);
+
+   // returns the name of the algorithm
+   DLLLOCAL static const char* getAlgorithmName(qore_compression_alg_e a);
+};
+
+// decompresses data written to it and passes the decompressed output to another sink
+class DecompressionSink : public AbstractCompressionSink {
+protected:
+   QoreCompressionStream& s;
+   AbstractCompressionSink& out;
+
+public:
+   DLLLOCAL DecompressionSink(QoreCompressionStream& n_s, AbstractCompressionSink& n_out) : s(n_s), out(n_out) {
+   }
+
+   DLLLOCAL virtual int write(const void* buf, size_t len, ExceptionSink* xsink) {
+      return s.update(buf, len, out, xsink);
+   }
+
+   // ends the decompression stream; returns 0 for OK, -1 for error
+   DLLLOCAL int finish(ExceptionSink* xsink) {
+      return s.finish(out, xsink);
+   }
+};
+
+#endif
@@ -0,0 +1,150 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+  QC_Digest.h
+
+  Qore Programming Language
+
+  Copyright (C) 2003 - 2015 David Nichols
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+  DEALINGS IN THE SOFTWARE.
+
+  Note that the Qore library is released under a choice of three open-source
+  licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+  information.
+*/
+
+#ifndef _QORE_QC_DIGEST_H
+#define _QORE_QC_DIGEST_H
+
+#include <qore/Qore.h>
+#include <qore/QoreSocketObject.h>
+#include <qore/intern/ql_crypto.h>
+
+#include <string>
+
+// size of the buffer used to read file data; reads are made directly into the buffer with this size
+#define QORE_DIGEST_FILE_BUFSIZE (1024 * 1024)
+// alignment of the file read buffer
+#define QORE_DIGEST_FILE_ALIGN 4096
+
+DLLEXPORT extern qore_classid_t CID_DIGEST;
+DLLLOCAL extern QoreClass* QC_DIGEST;
+
+DLLLOCAL QoreClass* initDigestClass(QoreNamespace& ns);
+
+// incremental message digest or HMAC calculation
+class QoreDigest : public AbstractPrivateData {
+protected:
+   // only one of the contexts is used, depending on whether a key was given
+   EVP_MD_CTX mdctx;
+   HMAC_CTX hctx;
+
+   // the digest algorithm
+   const EVP_MD* md;
+
+   // the exception code for errors calculating the digest
+   const char* err;
+
+   // the algorithm name
+   const char* name;
+
+   // the HMAC key, if any
+   std::string key;
+
+   // file read buffer; allocated on demand
+   void* fbuf;
+
+   mutable QoreThreadLock m;
+
+   // true if the digest is an HMAC
+   bool hmac;
+
+   // true if the context has been initialized
+   bool init;
+
+   // true if the digest has been finalized
+   bool done;
+
+   // total number of bytes processed
+   int64 total;
+
+   DLLLOCAL virtual ~QoreDigest();
+
+   // initializes the context; returns 0 for OK, -1 for error
+   DLLLOCAL int initIntern(ExceptionSink* xsink);
+
+   // frees the context
+   DLLLOCAL void cleanupIntern();
+
+   // returns 0 for OK, -1 for error
+   DLLLOCAL int checkUpdate(const char* meth, ExceptionSink* xsink) const;
+
+   // adds data to the digest; the lock must be held; returns 0 for OK, -1 for error
+   DLLLOCAL int updateIntern(const void* p, size_t len, ExceptionSink* xsink);
+
+   // returns the file read buffer; the lock must be held
+   DLLLOCAL void* getFileBuffer(ExceptionSink* xsink);
+
+public:
+   DLLLOCAL QoreDigest(const char* n_name, const EVP_MD* n_md, const char* n_err, ExceptionSink* xsink);
+   DLLLOCAL QoreDigest(const char* n_name, const EVP_MD* n_md, const char* n_err, const void* k, size_t klen, ExceptionSink* xsink);
+   DLLLOCAL QoreDigest(const QoreDigest& old, ExceptionSink* xsink);
+
+   // adds data to the digest; returns 0 for OK, -1 for error
+   DLLLOCAL int update(const void* p, size_t len, ExceptionSink* xsink);
+
+   // reads data from the file and adds it to the digest; if size is negative, data is read until the end of the file
+   // returns the number of bytes processed or -1 for error
+   DLLLOCAL int64 update(QoreFile& f, int64 size, ExceptionSink* xsink);
+
+   // receives data from the socket and adds it to the digest; if size is negative, data is read until the remote end
+   // closes the connection; returns the number of bytes processed or -1 for error
+   DLLLOCAL int64 update(QoreSocketObject& s, int64 size, int timeout_ms, ExceptionSink* xsink);
+
+   // finalizes the digest and returns the result; returns 0 for error
+   DLLLOCAL BinaryNode* final(ExceptionSink* xsink);
+
+   // restarts the calculation with the same algorithm and key
+   DLLLOCAL int reset(ExceptionSink* xsink);
+
+   DLLLOCAL const char* getAlgorithm() const {
+      return name;
+   }
+
+   DLLLOCAL bool isHmac() const {
+      return hmac;
+   }
+
+   DLLLOCAL int getSize() const {
+      return EVP_MD_size(md);
+   }
+
+   DLLLOCAL int64 getTotal() const {
+      return total;
+   }
+
+   // finds the algorithm with the given name; returns 0 for OK, -1 for error (exception raised)
+   DLLLOCAL static int getAlgorithm(const char* alg, const char*& name, const EVP_MD*& md, const char*& err, ExceptionSink* xsink);
+
+   // returns the digest of the file with the given path, read with large aligned reads; if hmac is true, an HMAC is
+   // calculated with the given key, which may be empty
+   DLLLOCAL static BinaryNode* hashFile(const char* path, const char* alg, bool hmac, const void* key, size_t klen, ExceptionSink* xsink);
+};
+
+#endif
@@ -76,6 +76,10 @@ public:
    DLLLOCAL static void setAccept(QoreSocketObject& sock, QoreObject* o) {
       sock.priv->setAccept(o);
    }
+
+   DLLLOCAL static my_socket_priv* get(QoreSocketObject& sock) {
+      return sock.priv;
+   }
 };
 
 #endif // _QORE_CLASS_QORESOCKET_H
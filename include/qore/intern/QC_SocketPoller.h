@@ -0,0 +1,135 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+  QC_SocketPoller.h
+
+  Qore Programming Language
+
+  Copyright (C) 2003 - 2015 David Nichols
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+  DEALINGS IN THE SOFTWARE.
+
+  Note that the Qore library is released under a choice of three open-source
+  licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+  information.
+*/
+
+#ifndef _QORE_QC_SOCKETPOLLER_H
+#define _QORE_QC_SOCKETPOLLER_H
+
+#include <qore/Qore.h>
+#include <qore/QoreSocketObject.h>
+
+#include <map>
+#include <deque>
+
+DLLEXPORT extern qore_classid_t CID_SOCKETPOLLER;
+DLLLOCAL extern QoreClass* QC_SOCKETPOLLER;
+
+DLLLOCAL QoreClass* initSocketPollerClass(QoreNamespace& ns);
+
+// waits on many sockets at once and returns the sockets that are ready to be read
+// sockets are registered for a single event; once a socket has been returned by wait() it is no longer registered
+class SocketPoller : public AbstractPrivateData {
+protected:
+   // registered socket
+   struct Entry {
+      // the Socket object; holds a reference
+      QoreObject* obj;
+      // the Socket object's private data; holds a reference so that the current descriptor can be checked
+      QoreSocketObject* so;
+      // user data for the socket; holds a reference
+      AbstractQoreNode* data;
+      // the socket's file descriptor when it was registered
+      int fd;
+      // true if the descriptor is being polled, false if the socket had buffered data when registered
+      bool polled;
+   };
+
+   // map of registration IDs to entries; IDs are never reused so events for removed sockets can be safely ignored
+   typedef std::map<int64, Entry> emap_t;
+   // map of Socket objects to registration IDs
+   typedef std::map<const QoreObject*, int64> omap_t;
+   // IDs of sockets that were ready when they were registered
+   typedef std::deque<int64> idq_t;
+
+   mutable QoreThreadLock m;
+   emap_t emap;
+   omap_t omap;
+   idq_t ready;
+
+   // the next registration ID; 0 is reserved for the wakeup pipe
+   int64 next_id;
+
+   // pipe used to wake up waiting threads
+   int wpipe[2];
+
+#ifdef HAVE_SYS_EPOLL_H
+   // the epoll descriptor
+   int epfd;
+#endif
+
+   // set when the object is closed; all waiting threads are woken up and new sockets cannot be registered
+   bool closed;
+
+   DLLLOCAL virtual ~SocketPoller();
+
+   // removes the entry and returns a hash of the socket and its data; must be called with the lock held
+   DLLLOCAL QoreHashNode* takeIntern(emap_t::iterator i);
+
+   // moves sockets registered with buffered data to the list; must be called with the lock held
+   DLLLOCAL void takeReadyIntern(QoreListNode& l, int max);
+
+   // wakes up all waiting threads; must be called with the lock held
+   DLLLOCAL void wakeupIntern();
+
+   // empties the wakeup pipe; must be called with the lock held
+   DLLLOCAL void drainIntern();
+
+public:
+   DLLLOCAL SocketPoller(ExceptionSink* xsink);
+
+   // registers the socket; returns -1 if an exception was raised
+   DLLLOCAL int add(QoreObject* obj, QoreSocketObject* so, QoreValue data, ExceptionSink* xsink);
+
+   // unregisters the socket; returns true if the socket was registered
+   DLLLOCAL bool remove(const QoreObject* obj, ExceptionSink* xsink);
+
+   // waits for registered sockets to be ready to be read and returns them
+   DLLLOCAL QoreListNode* wait(int timeout_ms, int max, ExceptionSink* xsink);
+
+   // unregisters all sockets and returns them
+   DLLLOCAL QoreListNode* removeAll(ExceptionSink* xsink);
+
+   // returns the number of registered sockets
+   DLLLOCAL int size() const {
+      AutoLocker al(m);
+      return (int)emap.size();
+   }
+
+   // wakes up all waiting threads and prevents new sockets from being registered
+   DLLLOCAL void close();
+
+   DLLLOCAL bool isClosed() const {
+      return closed;
+   }
+
+   DLLLOCAL virtual void deref(ExceptionSink* xsink);
+};
+
+#endif
@@ -52,14 +52,18 @@
 #include <qore/hash_map_include.h>
 #include <qore/intern/xxhash.h>
 
-typedef HASH_MAP<std::string, QoreMethod*> hm_method_t;
+// method maps are keyed by the method's name, so lookups do not require a temporary std::string
+typedef HASH_MAP<const char*, QoreMethod*, qore_hash_str, eqstr> hm_method_t;
 #else
-typedef std::map<std::string, QoreMethod*> hm_method_t;
+typedef std::map<const char*, QoreMethod*, ltstr> hm_method_t;
 #endif
 
 // forward reference to private class implementation
 class qore_class_private;
 
+// key table for hashes (defined in QoreHashNodeIntern.h)
+class qore_hash_keys;
+
 // map from abstract signature to variant for fast tracking of abstract variants
 typedef std::map<const char*, MethodVariantBase*, ltstr> vmap_t;
 
@@ -831,10 +835,10 @@ public:
    }
 
    // if the variant was identified at parse time, then variant will not be NULL, otherwise if NULL then it is identified at run time
-   DLLLOCAL QoreValue evalMethod(const AbstractQoreFunctionVariant* variant, QoreObject* self, const QoreListNode* args, ExceptionSink* xsink) const;
+   DLLLOCAL QoreValue evalMethod(const AbstractQoreFunctionVariant* variant, QoreObject* self, const QoreListNode* args, ExceptionSink* xsink, VariantCache* vc = 0) const;
 
    // if the variant was identified at parse time, then variant will not be NULL, otherwise if NULL then it is identified at run time
-   DLLLOCAL QoreValue evalPseudoMethod(const AbstractQoreFunctionVariant* variant, const QoreValue n, const QoreListNode* args, ExceptionSink* xsink) const;
+   DLLLOCAL QoreValue evalPseudoMethod(const AbstractQoreFunctionVariant* variant, const QoreValue n, const QoreListNode* args, ExceptionSink* xsink, VariantCache* vc = 0) const;
 };
 
 #define NMETHF(f) (reinterpret_cast<NormalMethodFunction*>(f))
@@ -849,7 +853,7 @@ public:
    DLLLOCAL virtual ~StaticMethodFunction() {
    }
    // if the variant was identified at parse time, then variant will not be NULL, otherwise if NULL then it is identified at run time
-   DLLLOCAL QoreValue evalMethod(const AbstractQoreFunctionVariant* variant, const QoreListNode* args, ExceptionSink* xsink) const;
+   DLLLOCAL QoreValue evalMethod(const AbstractQoreFunctionVariant* variant, const QoreListNode* args, ExceptionSink* xsink, VariantCache* vc = 0) const;
 };
 
 #define SMETHF(f) (reinterpret_cast<StaticMethodFunction*>(f))
@@ -1693,6 +1697,12 @@ public:
    // member lists (maps)
    QoreMemberMap members, pending_members;
 
+   // key table giving each declared member a fixed slot; object member hashes share this table when created, so
+   // in-object member references resolved at parse time can access members by position; new members are only
+   // appended so that slots stay valid when a class is extended in a later parse
+   qore_hash_keys* member_keys,
+      *pending_member_keys;            // key table including pending members; set in the second stage of parsing
+
    // static var lists (maps)
    QoreVarMap vars, pending_vars;
 
@@ -1718,7 +1728,8 @@ public:
       owns_ornothingtypeinfo : 1,       // do we own the "or nothing" type info
       pub : 1,                          // is a public class (modules only)
       final : 1,                        // is the class "final" (cannot be inherited)
-      inject : 1                        // has the class been injected
+      inject : 1,                       // has the class been injected
+      has_committed : 1                 // has the class been committed?
       ;
 
    int64 domain;                    // capabilities of builtin class to use in the context of parse restrictions
@@ -1746,6 +1757,9 @@ public:
    // pointer to owning program for imported classes
    QoreProgram* spgm;
 
+   // unique serial number for call-site caches; unlike the class ID it is not shared with copies and is never reused
+   unsigned serial;
+
    DLLLOCAL qore_class_private(QoreClass* n_cls, const char* nme, int64 dom = QDOM_DEFAULT, QoreTypeInfo* n_typeinfo = 0);
 
    // only called while the parse lock for the QoreProgram owning "old" is held
@@ -1934,6 +1948,15 @@ public:
       return rc;
    }
 
+   // creates the pending member key table if there are new members to add to it
+   DLLLOCAL void parseInitMemberKeys();
+
+   // returns the slot of the given declared member or -1 if the member has no slot
+   DLLLOCAL size_t parseGetMemberSlot(const char* mem) const;
+
+   // makes the member hash of a new object share the class member key table if the table is current
+   DLLLOCAL void initMemberKeys(QoreObject& o) const;
+
    DLLLOCAL bool parseHasPublicMembersInHierarchy() const {
       if (has_public_memdecl || pending_has_public_memdecl)
 	 return true;
@@ -2395,7 +2418,14 @@ public:
    }
    */
 
-   DLLLOCAL const QoreMethod* getMethodForEval(const char* nme, QoreProgram* pgm, ExceptionSink* xsink) const;
+   // finds a committed normal or static method for a call on an object at runtime without checking access
+   DLLLOCAL const QoreMethod* runtimeFindMethodForEval(const char* nme, QoreProgram* pgm, bool& priv_flag, ExceptionSink* xsink) const;
+
+   // if "mc" is not 0, then the method is found with the given call-site cache
+   DLLLOCAL const QoreMethod* getMethodForEval(const char* nme, QoreProgram* pgm, ExceptionSink* xsink, MethodCache* mc = 0) const;
+
+   // evaluates a method by name on an object of this class, the caches are used if not 0
+   DLLLOCAL QoreValue evalMethod(QoreObject* self, const char* nme, const QoreListNode* args, ExceptionSink* xsink, MethodCache* mc = 0, VariantCache* vc = 0) const;
 
    DLLLOCAL QoreObject* execConstructor(const AbstractQoreFunctionVariant* variant, const QoreListNode* args, ExceptionSink* xsink) const;
 
@@ -2424,12 +2454,12 @@ public:
    }
 
    DLLLOCAL QoreMethod* parseFindLocalMethod(const std::string& nme) {
-      hm_method_t::iterator i = hm.find(nme);
+      hm_method_t::iterator i = hm.find(nme.c_str());
       return (i != hm.end()) ? i->second : 0;
    }
    // returns a non-static method if it exists in the local class
    DLLLOCAL const QoreMethod* parseFindLocalMethod(const std::string& nme) const {
-      hm_method_t::const_iterator i = hm.find(nme);
+      hm_method_t::const_iterator i = hm.find(nme.c_str());
       return (i != hm.end()) ? i->second : 0;
    }
 
@@ -2555,7 +2585,7 @@ public:
 
    DLLLOCAL QoreValue evalPseudoMethod(const QoreValue n, const char* name, const QoreListNode* args, ExceptionSink* xsink) const;
 
-   DLLLOCAL QoreValue evalPseudoMethod(const QoreMethod* m, const AbstractQoreFunctionVariant* variant, const QoreValue n, const QoreListNode* args, ExceptionSink* xsink) const;
+   DLLLOCAL QoreValue evalPseudoMethod(const QoreMethod* m, const AbstractQoreFunctionVariant* variant, const QoreValue n, const QoreListNode* args, ExceptionSink* xsink, VariantCache* vc = 0) const;
 
    DLLLOCAL const QoreMethod* parseResolveSelfMethodIntern(const char* nme) {
       const QoreMethod* m = parseFindLocalMethod(nme);
@@ -2867,6 +2897,10 @@ public:
       return qc->priv->parseCheckInternalMemberAccess(mem, memberTypeInfo, loc);
    }
 
+   DLLLOCAL static size_t parseGetMemberSlot(const QoreClass* qc, const char* mem) {
+      return qc->priv->parseGetMemberSlot(mem);
+   }
+
    DLLLOCAL static int parseResolveInternalMemberAccess(const QoreClass* qc, const char* mem, const QoreTypeInfo*& memberTypeInfo) {
       return qc->priv->parseResolveInternalMemberAccess(mem, memberTypeInfo);
    }
@@ -2900,8 +2934,8 @@ public:
       return qc->priv->evalPseudoMethod(n, name, args, xsink);
    }
 
-   DLLLOCAL static QoreValue evalPseudoMethod(const QoreClass* qc, const QoreMethod* m, const AbstractQoreFunctionVariant* variant, const QoreValue n, const QoreListNode* args, ExceptionSink* xsink) {
-      return qc->priv->evalPseudoMethod(m, variant, n, args, xsink);
+   DLLLOCAL static QoreValue evalPseudoMethod(const QoreClass* qc, const QoreMethod* m, const AbstractQoreFunctionVariant* variant, const QoreValue n, const QoreListNode* args, ExceptionSink* xsink, VariantCache* vc = 0) {
+      return qc->priv->evalPseudoMethod(m, variant, n, args, xsink, vc);
    }
 
    DLLLOCAL static void setNamespace(QoreClass* qc, qore_ns_private* n) {
@@ -3038,20 +3072,20 @@ public:
       BSYSCONB(func)->eval(*parent_class, self, code, args);
    }
 
-   DLLLOCAL QoreValue eval(QoreObject* self, const QoreListNode* args, ExceptionSink* xsink) const {
+   DLLLOCAL QoreValue eval(QoreObject* self, const QoreListNode* args, ExceptionSink* xsink, VariantCache* vc = 0) const {
       if (!static_flag) {
          assert(self);
-         return NMETHF(func)->evalMethod(0, self, args, xsink);
+         return NMETHF(func)->evalMethod(0, self, args, xsink, vc);
       }
-      return SMETHF(func)->evalMethod(0, args, xsink);
+      return SMETHF(func)->evalMethod(0, args, xsink, vc);
    }
 
-   DLLLOCAL QoreValue evalPseudoMethod(const AbstractQoreFunctionVariant* variant, const QoreValue n, const QoreListNode* args, ExceptionSink* xsink) const {
+   DLLLOCAL QoreValue evalPseudoMethod(const AbstractQoreFunctionVariant* variant, const QoreValue n, const QoreListNode* args, ExceptionSink* xsink, VariantCache* vc = 0) const {
       QORE_TRACE("qore_method_private::evalPseudoMethod()");
 
       assert(!static_flag);
 
-      QoreValue rv = NMETHF(func)->evalPseudoMethod(variant, n, args, xsink);
+      QoreValue rv = NMETHF(func)->evalPseudoMethod(variant, n, args, xsink, vc);
       printd(5, "qore_method_private::evalPseudoMethod() %s::%s() returning type: %s\n", parent_class->getName(), getName(), rv.getTypeName());
       return rv;
    }
@@ -3062,12 +3096,12 @@ public:
       return m.priv->evalNormalVariant(self, ev, args, xsink);
    }
 
-   DLLLOCAL static QoreValue evalPseudoMethod(const QoreMethod* m, const AbstractQoreFunctionVariant* variant, const QoreValue n, const QoreListNode* args, ExceptionSink* xsink) {
-      return m->priv->evalPseudoMethod(variant, n, args, xsink);
+   DLLLOCAL static QoreValue evalPseudoMethod(const QoreMethod* m, const AbstractQoreFunctionVariant* variant, const QoreValue n, const QoreListNode* args, ExceptionSink* xsink, VariantCache* vc = 0) {
+      return m->priv->evalPseudoMethod(variant, n, args, xsink, vc);
    }
 
-   DLLLOCAL static QoreValue eval(const QoreMethod& m, QoreObject* self, const QoreListNode* args, ExceptionSink* xsink) {
-      return m.priv->eval(self, args, xsink);
+   DLLLOCAL static QoreValue eval(const QoreMethod& m, QoreObject* self, const QoreListNode* args, ExceptionSink* xsink, VariantCache* vc = 0) {
+      return m.priv->eval(self, args, xsink, vc);
    }
 };
 
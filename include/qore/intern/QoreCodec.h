@@ -0,0 +1,59 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+  QoreCodec.h
+
+  Qore Programming Language
+
+  Copyright (C) 2003 - 2015 David Nichols
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+  DEALINGS IN THE SOFTWARE.
+
+  Note that the Qore library is released under a choice of three open-source
+  licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+  information.
+*/
+
+#ifndef _QORE_QORECODEC_H
+#define _QORE_QORECODEC_H
+
+// the number of bytes after the end of the decoded data that can be overwritten by q_base64_decode()
+#define QORE_BASE64_DECODE_EXTRA 8
+
+// base64 decoding table; -1 for characters that are not base64 digits
+DLLLOCAL extern const signed char q_base64_dec[256];
+
+// returns the size of the base64 encoding of the given number of bytes including padding; if maxlinelen > 0, CRLF
+// characters are inserted after every maxlinelen encoded characters (not counting padding)
+DLLLOCAL qore_size_t q_base64_encoded_size(qore_size_t size, qore_size_t maxlinelen);
+
+// encodes the data to base64 with padding and without line breaks; writes exactly 4 * ((size + 2) / 3) characters
+DLLLOCAL void q_base64_encode(char* dst, const unsigned char* src, qore_size_t size);
+
+// decodes complete groups of 4 base64 digits and stops at the first group containing any other character (including
+// padding and line breaks); sets used to the number of characters decoded and returns the number of bytes written;
+// up to QORE_BASE64_DECODE_EXTRA bytes after the last byte written may also be overwritten
+DLLLOCAL qore_size_t q_base64_decode(unsigned char* dst, const char* src, qore_size_t len, qore_size_t& used);
+
+// encodes the data as lowercase hex digits; writes exactly size * 2 characters
+DLLLOCAL void q_hex_encode(char* dst, const unsigned char* src, qore_size_t size);
+
+// decodes pairs of hex digits and stops at the first pair containing an invalid digit; returns the number of bytes written
+DLLLOCAL qore_size_t q_hex_decode(unsigned char* dst, const char* src, qore_size_t len);
+
+#endif
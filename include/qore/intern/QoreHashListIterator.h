@@ -168,7 +168,8 @@ public:
       if (checkPtr(xsink))
          return 0;
 
-      ReferenceHolder<QoreHashNode> rv(new QoreHashNode, xsink);
+      // rows share the key table of the column hash
+      ReferenceHolder<QoreHashNode> rv(h->copyKeys(), xsink);
 
       ConstHashIterator hi(h);
       while (hi.next()) {
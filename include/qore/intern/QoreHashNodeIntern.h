@@ -33,62 +33,481 @@
 
 #define _QORE_QOREHASHNODEINTERN_H
 
-#include <qore/qlist>
+#include <qore/intern/xxhash.h>
 
-// to maintain the order of inserts
-class HashMember {
-public:
-   AbstractQoreNode* node;
+#include <vector>
+
+// hashes with fewer entries than this are searched with a linear scan; larger hashes get an index
+#define QORE_HASH_INDEX_MIN 8
+
+// number of values in each block of a hash's value table
+#define QORE_HASH_VAL_BLOCK 8
+
+// a key in a hash; keys are stored inline in insertion order
+struct qore_hash_key {
    std::string key;
+   // qore_hash_str value of the key; only set while the hash has an index
+   size_t hash;
+   // position of the key's value in the value table
+   unsigned val;
+   // deleted entries are skipped and reclaimed when the tables need to grow
+   bool deleted;
+
+   DLLLOCAL qore_hash_key(const char* n_key, size_t n_hash, unsigned n_val) : key(n_key), hash(n_hash), val(n_val), deleted(false) {
+   }
+};
+
+typedef std::vector<qore_hash_key> qhkey_vec_t;
+typedef std::vector<unsigned> qhpos_vec_t;
+
+// the value table of a hash; values are stored in fixed-size blocks that are never moved, and a value keeps its
+// position for as long as its key is in the hash, so pointers to values remain valid when other keys are added
+// or removed
+class qore_hash_vals {
+protected:
+   // the first block; most hashes only need one
+   AbstractQoreNode** first;
+   // further blocks
+   std::vector<AbstractQoreNode**> blocks;
+   size_t len;
+
+   DLLLOCAL qore_hash_vals(const qore_hash_vals&);
+   DLLLOCAL qore_hash_vals& operator=(const qore_hash_vals&);
 
-   DLLLOCAL HashMember(const char* n_key) : node(0), key(n_key) {
+public:
+   DLLLOCAL qore_hash_vals() : first(0), len(0) {
+   }
+
+   DLLLOCAL ~qore_hash_vals() {
+      clear();
+   }
+
+   DLLLOCAL size_t size() const {
+      return len;
+   }
+
+   DLLLOCAL AbstractQoreNode*& operator[](size_t i) {
+      assert(i < len);
+      return i < QORE_HASH_VAL_BLOCK ? first[i] : blocks[i / QORE_HASH_VAL_BLOCK - 1][i % QORE_HASH_VAL_BLOCK];
    }
 
-   DLLLOCAL ~HashMember() {
+   DLLLOCAL AbstractQoreNode* operator[](size_t i) const {
+      assert(i < len);
+      return i < QORE_HASH_VAL_BLOCK ? first[i] : blocks[i / QORE_HASH_VAL_BLOCK - 1][i % QORE_HASH_VAL_BLOCK];
+   }
+
+   DLLLOCAL void push_back(AbstractQoreNode* v) {
+      if (!(len % QORE_HASH_VAL_BLOCK)) {
+         AbstractQoreNode** b = new AbstractQoreNode*[QORE_HASH_VAL_BLOCK];
+         if (!len)
+            first = b;
+         else
+            blocks.push_back(b);
+      }
+      ++len;
+      (*this)[len - 1] = v;
+   }
+
+   // adds empty values until the table has the given size
+   DLLLOCAL void grow(size_t size) {
+      while (len < size)
+         push_back(0);
+   }
+
+   DLLLOCAL void clear() {
+      if (!first)
+         return;
+      delete [] first;
+      first = 0;
+      for (std::vector<AbstractQoreNode**>::iterator i = blocks.begin(), e = blocks.end(); i != e; ++i)
+         delete [] *i;
+      blocks.clear();
+      len = 0;
    }
 };
 
-typedef qlist<HashMember*> qhlist_t;
+// the key table of a hash: keys in insertion order (including deleted entries) and an optional index
+// tables are reference counted so that hashes with the same keys can share them; a shared table is never
+// modified, hashes copy it before adding or removing keys
+class qore_hash_keys : public QoreReferenceCounter {
+public:
+   qhkey_vec_t keys;
+   // open-addressing index of key positions + 1 (0 = empty slot); only allocated for larger tables
+   unsigned* index;
+   // index size - 1; the index size is always a power of 2
+   size_t mask;
+   // the size of the value table of hashes using this table
+   size_t vsize;
+   // value positions not used by any key; they are reused for new keys
+   qhpos_vec_t free_vals;
+
+   DLLLOCAL qore_hash_keys() : index(0), mask(0), vsize(0) {
+   }
 
-#ifdef HAVE_QORE_HASH_MAP
-//#warning compiling with hash_map
-#include <qore/hash_map_include.h>
-#include <qore/intern/xxhash.h>
+   // creates an unshared copy of the table with the same positions
+   DLLLOCAL qore_hash_keys(const qore_hash_keys& old) : keys(old.keys), index(0), mask(0), vsize(old.vsize), free_vals(old.free_vals) {
+      if (old.index)
+         makeIndex();
+   }
 
-typedef HASH_MAP<const char*, qhlist_t::iterator, qore_hash_str, eqstr> hm_hm_t;
-#else
-typedef std::map<const char*, qhlist_t::iterator, ltstr> hm_hm_t;
-#endif
+   DLLLOCAL ~qore_hash_keys() {
+      delete [] index;
+   }
+
+   DLLLOCAL void deref() {
+      if (ROdereference())
+         delete this;
+   }
+
+   DLLLOCAL bool shared() const {
+      return reference_count() > 1;
+   }
+
+   DLLLOCAL size_t size() const {
+      return keys.size();
+   }
+
+   // returns the position of the given key or qore_hash_private::npos if it's not present
+   DLLLOCAL size_t find(const char* key) const {
+      assert(key);
+      if (!index) {
+         for (size_t i = 0, e = keys.size(); i < e; ++i) {
+            if (!keys[i].deleted && !strcmp(keys[i].key.c_str(), key))
+               return i;
+         }
+         return (size_t)-1;
+      }
+      return findIndex(key, qore_hash_str()(key));
+   }
+
+   DLLLOCAL size_t findIndex(const char* key, size_t h) const {
+      assert(index);
+      for (size_t s = h & mask; index[s]; s = (s + 1) & mask) {
+         const qore_hash_key& k = keys[index[s] - 1];
+         if (k.hash == h && !k.deleted && !strcmp(k.key.c_str(), key))
+            return index[s] - 1;
+      }
+      return (size_t)-1;
+   }
+
+   // adds a new key and returns its position; the key must not already be present
+   DLLLOCAL size_t add(const char* key, size_t h) {
+      assert(!shared());
+      unsigned v;
+      if (free_vals.empty())
+         v = (unsigned)vsize++;
+      else {
+         v = free_vals.back();
+         free_vals.pop_back();
+      }
+
+      size_t i = keys.size();
+      keys.push_back(qore_hash_key(key, h, v));
+
+      if (index) {
+         // keep the index at most half full
+         if (keys.size() * 2 > mask + 1)
+            makeIndex();
+         else
+            addIndex(i);
+      }
+      else if (keys.size() >= QORE_HASH_INDEX_MIN)
+         rebuildIndex();
+
+      return i;
+   }
+
+   DLLLOCAL void addIndex(size_t i) {
+      size_t s = keys[i].hash & mask;
+      while (index[s])
+         s = (s + 1) & mask;
+      index[s] = (unsigned)(i + 1);
+   }
+
+   // (re)creates the index, calculating the key hashes if there was no index
+   DLLLOCAL void rebuildIndex() {
+      if (!index) {
+         for (qhkey_vec_t::iterator i = keys.begin(), e = keys.end(); i != e; ++i)
+            i->hash = qore_hash_str()(i->key.c_str());
+      }
+      makeIndex();
+   }
+
+   // creates the index from the key hashes
+   DLLLOCAL void makeIndex() {
+      delete [] index;
+
+      size_t size = QORE_HASH_INDEX_MIN * 2;
+      while (size < keys.size() * 4)
+         size <<= 1;
+      mask = size - 1;
+      index = new unsigned[size];
+      memset(index, 0, sizeof(unsigned) * size);
+
+      for (size_t i = 0, e = keys.size(); i < e; ++i) {
+         if (!keys[i].deleted)
+            addIndex(i);
+      }
+   }
+};
 
 class qore_hash_private {
 public:
-   qhlist_t member_list;
-   hm_hm_t hm;
+   // key table; 0 if the hash is empty
+   qore_hash_keys* kt;
+   // values; the position of each key's value is stored in the key table
+   qore_hash_vals vals;
+   // number of live (not deleted) keys
+   size_t len;
    unsigned obj_count;
 #ifdef DEBUG
    bool is_obj;
 #endif
 
-   DLLLOCAL qore_hash_private() : obj_count(0)
+   // invalid position
+   static const size_t npos = (size_t)-1;
+
+   DLLLOCAL qore_hash_private() : kt(0), len(0), obj_count(0)
 #ifdef DEBUG
                                 , is_obj(0)
-#endif                                  
+#endif
    {
    }
-      
-   // hashes should always be empty by the time they are deleted 
+
+   // hashes should always be empty by the time they are deleted
    // because object destructors need to be run...
    DLLLOCAL ~qore_hash_private() {
-      assert(member_list.empty());
+      assert(!len);
+      if (kt)
+         kt->deref();
+   }
+
+   // returns the position of the given key or npos if it's not present
+   DLLLOCAL size_t find(const char* key) const {
+      return kt ? kt->find(key) : npos;
+   }
+
+   // returns the position in the value table of the value of the key at the given position; the value keeps this
+   // position until the key is removed
+   DLLLOCAL size_t getValuePos(size_t i) const {
+      return kt->keys[i].val;
+   }
+
+   // returns the value position of the given key or npos if it's not present; if "create" is true, then the key is
+   // added with no value if it's not present
+   DLLLOCAL size_t findValuePos(const char* key, bool create) {
+      size_t i = create ? findCreate(key) : find(key);
+      return i == npos ? npos : getValuePos(i);
+   }
+
+   // returns the value of the key at the given position
+   DLLLOCAL AbstractQoreNode* getValue(size_t i) const {
+      return vals[kt->keys[i].val];
+   }
+
+   DLLLOCAL AbstractQoreNode*& getValueRef(size_t i) {
+      return vals[kt->keys[i].val];
+   }
+
+   // returns the position of the given key, checking the given slot first; slots are positions in a class's
+   // member key table (see qore_class_private::member_keys), which object member hashes start out sharing
+   DLLLOCAL size_t findSlot(const char* key, size_t slot) const {
+      if (kt && slot < kt->size()) {
+         const qore_hash_key& k = kt->keys[slot];
+         if (!k.deleted && !strcmp(k.key.c_str(), key))
+            return slot;
+      }
+      return find(key);
+   }
+
+   // makes an empty hash use the given key table with no values
+   DLLLOCAL void setKeys(qore_hash_keys* n_kt) {
+      assert(!kt && !len);
+      kt = n_kt;
+      kt->ROreference();
+      vals.grow(kt->vsize);
+      len = kt->size();
+   }
+
+   // returns the position of the given key, adding it with no value if it's not present
+   DLLLOCAL size_t findCreate(const char* key) {
+      if (!kt || !kt->index) {
+         size_t i = find(key);
+         return i != npos ? i : add(key, 0);
+      }
+
+      size_t h = qore_hash_str()(key);
+      size_t i = kt->findIndex(key, h);
+      return i != npos ? i : add(key, h);
+   }
+
+   // adds a new key with no value and returns its position; the key must not already be present
+   DLLLOCAL size_t add(const char* key, size_t h) {
+      if (!kt)
+         kt = new qore_hash_keys;
+      else {
+         unshare();
+         // reclaim deleted entries instead of growing the tables when they make up at least half of them
+         if (kt->keys.size() == kt->keys.capacity() && kt->keys.size() - len >= len)
+            compact();
+      }
+
+      size_t i = kt->add(key, h);
+      vals.grow(kt->vsize);
+      assert(!getValue(i));
+      ++len;
+      return i;
+   }
+
+   // makes sure that the key table is not shared with another hash before it's modified
+   DLLLOCAL void unshare() {
+      if (kt->shared()) {
+         qore_hash_keys* nkt = new qore_hash_keys(*kt);
+         kt->deref();
+         kt = nkt;
+      }
+   }
+
+   // uses the given hash's key table if it has the same keys with the same key and value positions as this hash;
+   // returns true if the table was replaced
+   DLLLOCAL bool shareKeys(const qore_hash_private& other) {
+      if (!kt || !other.kt || kt == other.kt || kt->size() != other.kt->size() || kt->vsize != other.kt->vsize)
+         return false;
+
+      for (size_t i = 0, e = kt->size(); i < e; ++i) {
+         const qore_hash_key& k = kt->keys[i];
+         const qore_hash_key& ok = other.kt->keys[i];
+         if (k.deleted != ok.deleted || (!k.deleted && (k.key != ok.key || k.val != ok.val)))
+            return false;
+      }
+
+      kt->deref();
+      kt = other.kt;
+      kt->ROreference();
+      return true;
+   }
+
+   // removes deleted entries from the key table; invalidates key positions but not value positions
+   DLLLOCAL void compact() {
+      assert(!kt->shared());
+      qhkey_vec_t& keys = kt->keys;
+      size_t j = 0;
+      for (size_t i = 0, e = keys.size(); i < e; ++i) {
+         if (keys[i].deleted)
+            continue;
+         if (i != j) {
+            keys[j].key.swap(keys[i].key);
+            keys[j].hash = keys[i].hash;
+            keys[j].val = keys[i].val;
+            keys[j].deleted = false;
+         }
+         ++j;
+      }
+      assert(j == len);
+      keys.erase(keys.begin() + j, keys.end());
+
+      if (kt->index)
+         kt->makeIndex();
+   }
+
+   // removes the entry at the given position; the value must already have been dereferenced or taken
+   DLLLOCAL void erase(size_t i) {
+      assert(!kt->keys[i].deleted);
+      assert(len);
+      if (!--len) {
+         clearTables();
+         return;
+      }
+
+      unshare();
+      qore_hash_key& k = kt->keys[i];
+      k.deleted = true;
+      // free any key memory immediately
+      std::string().swap(k.key);
+      vals[k.val] = 0;
+      kt->free_vals.push_back(k.val);
+   }
+
+   DLLLOCAL void clearTables() {
+      if (kt) {
+         kt->deref();
+         kt = 0;
+      }
+      vals.clear();
+      len = 0;
+   }
+
+   // returns the number of entries in the key table including deleted entries
+   DLLLOCAL size_t tableSize() const {
+      return kt ? kt->size() : 0;
+   }
+
+   DLLLOCAL const std::string& getKey(size_t i) const {
+      assert(i < tableSize());
+      return kt->keys[i].key;
+   }
+
+   // returns the position of the next live entry after the given position or npos if there are no more entries
+   // (npos as the argument returns the first entry)
+   DLLLOCAL size_t next(size_t i) const {
+      for (size_t e = tableSize(); ++i < e;) {
+         if (!kt->keys[i].deleted)
+            return i;
+      }
+      return npos;
+   }
+
+   // returns the position of the live entry before the given position or npos if there are no more entries
+   // (tableSize() as the argument returns the last entry)
+   DLLLOCAL size_t prev(size_t i) const {
+      while (i) {
+         if (!kt->keys[--i].deleted)
+            return i;
+      }
+      return npos;
+   }
+
+   // returns a new hash sharing this hash's key table with no values
+   DLLLOCAL QoreHashNode* copyKeys() const {
+      QoreHashNode* h = new QoreHashNode;
+      if (len) {
+         qore_hash_private& p = *h->priv;
+         p.kt = kt;
+         kt->ROreference();
+         p.vals.grow(kt->vsize);
+         p.len = len;
+      }
+      return h;
+   }
+
+   // makes the first hash use the key table of the second if they have the same keys
+   DLLLOCAL static bool shareKeys(QoreHashNode& h, const QoreHashNode& other) {
+      return h.priv->shareKeys(*other.priv);
+   }
+
+   // makes hashes in the given list with the same keys as the hash before them share the same key table
+   DLLLOCAL static void shareKeys(QoreListNode& l) {
+      qore_hash_private* last = 0;
+      for (size_t i = 0, e = l.size(); i < e; ++i) {
+         AbstractQoreNode* n = l.retrieve_entry(i);
+         if (get_node_type(n) != NT_HASH) {
+            last = 0;
+            continue;
+         }
+         qore_hash_private* h = reinterpret_cast<QoreHashNode*>(n)->priv;
+         if (last)
+            h->shareKeys(*last);
+         last = h;
+      }
    }
 
    DLLLOCAL int64 getKeyAsBigInt(const char* key, bool &found) const {
-      assert(key);	 
-      hm_hm_t::const_iterator i = hm.find(key);
+      size_t i = find(key);
 
-      if (i != hm.end()) {
+      if (i != npos) {
          found = true;
-         return (*(i->second))->node ? (*(i->second))->node->getAsBigInt() : 0;
+         AbstractQoreNode* v = getValue(i);
+         return v ? v->getAsBigInt() : 0;
       }
 
       found = false;
@@ -96,12 +515,12 @@ public:
    }
 
    DLLLOCAL bool getKeyAsBool(const char* key, bool& found) const {
-      assert(key);	 
-      hm_hm_t::const_iterator i = hm.find(key);
+      size_t i = find(key);
 
-      if (i != hm.end()) {
+      if (i != npos) {
          found = true;
-         return (*(i->second))->node ? (*(i->second))->node->getAsBool() : false;
+         AbstractQoreNode* v = getValue(i);
+         return v ? v->getAsBool() : false;
       }
 
       found = false;
@@ -109,116 +528,77 @@ public:
    }
 
    DLLLOCAL bool existsKey(const char* key) const {
-      assert(key);	 
-      return hm.find(key) != hm.end();
+      return find(key) != npos;
    }
 
    DLLLOCAL bool existsKeyValue(const char* key) const {
-      assert(key);	 
-      hm_hm_t::const_iterator i = hm.find(key);
-      if (i == hm.end())
+      size_t i = find(key);
+      if (i == npos)
          return false;
-      return !is_nothing((*(i->second))->node);
-   }
-
-   DLLLOCAL HashMember* findMember(const char* key) {
-      assert(key);
-      hm_hm_t::iterator i = hm.find(key);
-      return i != hm.end() ? (*(i->second)) : 0;
+      return !is_nothing(getValue(i));
    }
 
-   DLLLOCAL HashMember* findCreateMember(const char* key) {
-      // otherwise create the new hash entry
-      HashMember* om = findMember(key);
-      if (om)
-	 return om;
-
-      om = new HashMember(key);
-      member_list.push_back(om);
-
-      // add to the map
-      qhlist_t::iterator i = member_list.end();
-      --i;
-      hm[om->key.c_str()] = i;
-
-      // return the new member
-      return om;
+   // returns a pointer to the value of the given key or 0 if the key is not present
+   // NOTE: the pointer is valid until the key is removed from the hash
+   DLLLOCAL AbstractQoreNode** findMember(const char* key) {
+      size_t i = find(key);
+      return i != npos ? &getValueRef(i) : 0;
    }
 
-   DLLLOCAL AbstractQoreNode **getKeyValuePtr(const char* key) {
-      return &findCreateMember(key)->node;
+   // returns a pointer to the value of the given key, creating the key if necessary
+   // NOTE: the pointer is valid until the key is removed from the hash
+   DLLLOCAL AbstractQoreNode** findCreateMember(const char* key) {
+      return &getValueRef(findCreate(key));
    }
 
-   // NOTE: does not delete the value, this must be done by the caller before this call
-   // also does not delete map entry; must be done outside this call
-   DLLLOCAL void internDeleteKey(qhlist_t::iterator i) {
-      HashMember* om = *i;
-
-      member_list.erase(i);
-
-      // free om memory
-      delete om;
+   DLLLOCAL AbstractQoreNode** getKeyValuePtr(const char* key) {
+      return findCreateMember(key);
    }
 
    DLLLOCAL void deleteKey(const char* key, ExceptionSink *xsink) {
-      assert(key);
-      
-      hm_hm_t::iterator i = hm.find(key);
-      
-      if (i == hm.end())
+      size_t i = find(key);
+
+      if (i == npos)
          return;
 
-      qhlist_t::iterator li = i->second;      
-      hm.erase(i);
-      
       // dereference node if present
-      if ((*li)->node) {
-         if (get_container_obj((*li)->node))
+      AbstractQoreNode* n = getValue(i);
+      erase(i);
+      if (n) {
+         if (get_container_obj(n))
             incObjectCount(-1);
 
-         if ((*li)->node->getType() == NT_OBJECT)
-            reinterpret_cast<QoreObject*>((*li)->node)->doDelete(xsink);
-         (*li)->node->deref(xsink);
+         if (n->getType() == NT_OBJECT)
+            reinterpret_cast<QoreObject*>(n)->doDelete(xsink);
+         n->deref(xsink);
       }
-      
-      internDeleteKey(li);
    }
 
    // removes the value and dereferences it, without performing a delete on it
    DLLLOCAL void removeKey(const char* key, ExceptionSink *xsink) {
-      assert(key);
-      
-      hm_hm_t::iterator i = hm.find(key);
-      
-      if (i == hm.end())
+      size_t i = find(key);
+
+      if (i == npos)
          return;
-      
-      qhlist_t::iterator li = i->second;      
-      hm.erase(i);
-      
+
       // dereference node if present
-      if ((*li)->node) {
-         if (get_container_obj((*li)->node))
+      AbstractQoreNode* n = getValue(i);
+      erase(i);
+      if (n) {
+         if (get_container_obj(n))
             incObjectCount(-1);
-         (*li)->node->deref(xsink);
+         n->deref(xsink);
       }
-      
-      internDeleteKey(li);
    }
 
    DLLLOCAL AbstractQoreNode *takeKeyValue(const char* key) {
-      assert(key);
+      size_t i = find(key);
 
-      hm_hm_t::iterator i = hm.find(key);
-      
-      if (i == hm.end())
+      if (i == npos)
          return 0;
-      
-      qhlist_t::iterator li = i->second;      
-      hm.erase(i);
-      
-      AbstractQoreNode *rv = (*li)->node;
-      internDeleteKey(li);
+
+      AbstractQoreNode *rv = getValue(i);
+      erase(i);
 
       if (get_container_obj(rv))
          incObjectCount(-1);
@@ -227,44 +607,52 @@ public:
    }
 
    DLLLOCAL const char* getFirstKey() const  {
-      return member_list.empty() ? 0 : member_list.front()->key.c_str(); 
+      size_t i = next(npos);
+      return i == npos ? 0 : kt->keys[i].key.c_str();
    }
-   
+
    DLLLOCAL const char* getLastKey() const {
-      return member_list.empty() ? 0 : member_list.back()->key.c_str(); 
+      size_t i = prev(tableSize());
+      return i == npos ? 0 : kt->keys[i].key.c_str();
    }
 
    DLLLOCAL QoreListNode* getKeys() const {
       QoreListNode* list = new QoreListNode;
 
-      for (qhlist_t::const_iterator i = member_list.begin(), e = member_list.end(); i != e; ++i) {
-         list->push(new QoreStringNode((*i)->key));
-      }
+      for (size_t i = next(npos); i != npos; i = next(i))
+         list->push(new QoreStringNode(kt->keys[i].key));
       return list;
    }
 
    DLLLOCAL void merge(const qore_hash_private& h, ExceptionSink* xsink) {
-      for (qhlist_t::const_iterator i = h.member_list.begin(), e = h.member_list.end(); i != e; ++i) {
-         setKeyValue((*i)->key, (*i)->node ? (*i)->node->refSelf() : 0, xsink);
+      for (size_t i = h.next(npos); i != npos; i = h.next(i)) {
+         AbstractQoreNode* v = h.getValue(i);
+         setKeyValue(h.kt->keys[i].key, v ? v->refSelf() : 0, xsink);
       }
    }
 
    DLLLOCAL QoreHashNode* copy() const {
       QoreHashNode* h = new QoreHashNode;
-
-      // copy all members to new object
-      for (qhlist_t::const_iterator i = member_list.begin(), e = member_list.end(); i != e; ++i) {
-         //printd(5, "QoreHashNode::copy() this=%p node=%p key='%s'\n", this, where->node, where->key);
-         h->setKeyValue((*i)->key, (*i)->node ? (*i)->node->refSelf() : 0, 0);
-      }
+      if (!len)
+         return h;
+
+      // the copy shares the key table until keys are added to or removed from either hash
+      qore_hash_private& p = *h->priv;
+      p.kt = kt;
+      kt->ROreference();
+      for (size_t i = 0, e = vals.size(); i < e; ++i)
+         p.vals.push_back(vals[i] ? vals[i]->refSelf() : 0);
+      p.len = len;
+      p.obj_count = obj_count;
       return h;
    }
 
    DLLLOCAL AbstractQoreNode* evalImpl(ExceptionSink* xsink) const {
       QoreHashNodeHolder h(new QoreHashNode(), xsink);
 
-      for (qhlist_t::const_iterator i = member_list.begin(), e = member_list.end(); i != e; ++i) {
-         h->setKeyValue((*i)->key, (*i)->node ? (*i)->node->eval(xsink) : 0, 0);
+      for (size_t i = next(npos); i != npos; i = next(i)) {
+         AbstractQoreNode* v = getValue(i);
+         h->setKeyValue(kt->keys[i].key, v ? v->eval(xsink) : 0, 0);
          if (*xsink)
             return 0;
       }
@@ -278,14 +666,12 @@ public:
    }
 
    DLLLOCAL bool derefImpl(ExceptionSink* xsink) {
-      for (qhlist_t::iterator i = member_list.begin(), e = member_list.end(); i != e; ++i) {
-         if ((*i)->node)
-            (*i)->node->deref(xsink);
-         delete *i;
+      for (size_t i = 0, e = vals.size(); i < e; ++i) {
+         if (vals[i])
+            vals[i]->deref(xsink);
       }
 
-      member_list.clear();
-      hm.clear();
+      clearTables();
       obj_count = 0;
       return true;
    }
@@ -295,11 +681,11 @@ public:
    }
 
    DLLLOCAL size_t size() const {
-      return member_list.size();
+      return len;
    }
 
    DLLLOCAL bool empty() const {
-      return member_list.empty();
+      return !len;
    }
 
    DLLLOCAL void incObjectCount(int dt) {
@@ -317,12 +703,14 @@ public:
       h.priv->incObjectCount(dt);
    }
 
-   DLLLOCAL static AbstractQoreNode* getFirstKeyValue(const QoreHashNode* h) { 
-      return h->priv->member_list.empty() ? 0 : h->priv->member_list.front()->node;
-   }  
-   
+   DLLLOCAL static AbstractQoreNode* getFirstKeyValue(const QoreHashNode* h) {
+      size_t i = h->priv->next(npos);
+      return i == npos ? 0 : h->priv->getValue(i);
+   }
+
    DLLLOCAL static AbstractQoreNode* getLastKeyValue(const QoreHashNode* h) {
-      return h->priv->member_list.empty() ? 0 : h->priv->member_list.back()->node;
+      size_t i = h->priv->prev(h->priv->tableSize());
+      return i == npos ? 0 : h->priv->getValue(i);
    }
 };
 
@@ -321,6 +321,7 @@ DLLLOCAL extern QoreClass* QC_PSEUDONOTHING;
 
 DLLLOCAL bool node_has_effect(const AbstractQoreNode* n);
 
+#include <qore/intern/qore_atomic.h>
 #include <qore/intern/NamedScope.h>
 #include <qore/intern/QoreTypeInfo.h>
 #include <qore/intern/ParseNode.h>
@@ -566,9 +567,10 @@ class qore_hash_private;
 class hash_assignment_priv {
 public:
    qore_hash_private& h;
-   HashMember* om;
+   // position of the key's value in the hash's value table; it remains valid when other keys are added or removed
+   size_t pos;
 
-   DLLLOCAL hash_assignment_priv(qore_hash_private& n_h, HashMember* n_om) : h(n_h), om(n_om) {
+   DLLLOCAL hash_assignment_priv(qore_hash_private& n_h, size_t n_pos) : h(n_h), pos(n_pos) {
    }
 
    DLLLOCAL hash_assignment_priv(qore_hash_private& n_h, const char* key, bool must_already_exist = false);
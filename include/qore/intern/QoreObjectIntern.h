@@ -307,8 +307,25 @@ public:
    DLLLOCAL int rSectionTid() const {
       return static_cast<qore_rsection_priv*>(priv)->rSectionTid();
    }
+
+   // allows the current thread to make reads without locking until another thread grabs the write lock
+   DLLLOCAL void setBias() {
+      priv->setBias();
+   }
+};
+
+// number of locks shared by all objects for reference count and recursive scan management
+#define QORE_OBJECT_LOCK_STRIPES 64
+
+// a lock and condition shared by all objects hashed to the same stripe; the lock is only held for short critical
+// sections that do not acquire any other lock, so sharing it between objects cannot cause deadlocks
+struct ObjectLockStripe {
+   QoreThreadLock l;
+   QoreCondition c;
 };
 
+DLLLOCAL extern ObjectLockStripe qore_object_lock_stripes[QORE_OBJECT_LOCK_STRIPES];
+
 /* Qore object recursive reference handling works as follows: objects are sorted into sets making up
    directed cyclic graphs.
 
@@ -537,11 +554,9 @@ public:
    const QoreClass* theclass;
    int status;
 
-   // read-write lock with special rsection handling
+   // read-write lock with special rsection handling; biased to the creating thread for objects created by Qore code
    mutable RSectionLock rml;
 
-   // used for weak references, to ensure that assignments will not deadlock when the object is locked for update
-   mutable QoreThreadLock ref_mutex;
    KeyList* privateData;
    QoreReferenceCounter tRefs;  // weak references
    QoreHashNode* data;
@@ -550,9 +565,6 @@ public:
    bool system_object, delete_blocker_run, in_destructor;
    bool recursive_ref_found;
 
-   QoreThreadLock rlck;
-   QoreCondition rdone; // recursive scan done flag
-
    int rscan,   // TID flag for starting a recursive scan
       rcount,   // the number of unique recursive references to this object
       rwaiting, // the number of threads waiting for a scan of this object
@@ -564,6 +576,16 @@ public:
 
    DLLLOCAL qore_object_private(QoreObject* n_obj, const QoreClass *oc, QoreProgram* p, QoreHashNode* n_data);
 
+   // returns the shared lock and condition used for the reference count and the recursive scan flag
+   DLLLOCAL ObjectLockStripe& getStripe() const {
+      return qore_object_lock_stripes[(reinterpret_cast<size_t>(this) >> 6) & (QORE_OBJECT_LOCK_STRIPES - 1)];
+   }
+
+   // used for weak references, to ensure that assignments will not deadlock when the object is locked for update
+   DLLLOCAL QoreThreadLock& refMutex() const {
+      return getStripe().l;
+   }
+
    DLLLOCAL ~qore_object_private() {
       assert(!pgm);
       assert(!data);
@@ -589,6 +611,13 @@ public:
 
    DLLLOCAL int getLValue(const char* key, LValueHelper& lvh, bool internal, bool for_remove, ExceptionSink* xsink) const;
 
+   // gets an lvalue for a member with the given type checking the given slot in the member hash first; no member
+   // access checks are made
+   DLLLOCAL int getSlotLValue(const char* key, size_t slot, const QoreTypeInfo* mti, LValueHelper& lvh, bool for_remove, ExceptionSink* xsink) const;
+
+   // returns a referenced member value checking the given slot in the member hash first
+   DLLLOCAL AbstractQoreNode* getReferencedSlotMember(const char* mem, size_t slot, ExceptionSink* xsink) const;
+
    DLLLOCAL AbstractQoreNode* *getMemberValuePtr(const char* key, AutoVLock *vl, const QoreTypeInfo*& typeInfo, ExceptionSink* xsink) const;
 
    DLLLOCAL QoreStringNode* firstKey(ExceptionSink* xsink) {
@@ -780,7 +809,7 @@ public:
 
       // increment reference count temporarily for destructor
       {
-	 AutoLocker slr(ref_mutex);
+	 AutoLocker slr(refMutex());
 	 ++obj->references;
       }
 
@@ -835,7 +864,7 @@ public:
 #endif
 
       {
-	 AutoLocker slr(ref_mutex);
+	 AutoLocker slr(refMutex());
 	 if (--obj->references)
 	    return;
       }
@@ -1005,6 +1034,17 @@ public:
       return obj.priv->getLValue(key, lvh, internal, for_remove, xsink);
    }
 
+   DLLLOCAL static int getSlotLValue(const QoreObject& obj, const char* key, size_t slot, const QoreTypeInfo* mti, LValueHelper& lvh, bool for_remove, ExceptionSink* xsink) {
+      return obj.priv->getSlotLValue(key, slot, mti, lvh, for_remove, xsink);
+   }
+
+   DLLLOCAL static AbstractQoreNode* getReferencedSlotMember(const QoreObject& obj, const char* mem, size_t slot, ExceptionSink* xsink) {
+      return obj.priv->getReferencedSlotMember(mem, slot, xsink);
+   }
+
+   // makes the member hash of a new object share the given class member key table
+   DLLLOCAL static void setMemberKeys(QoreObject& obj, qore_hash_keys* kt);
+
    DLLLOCAL static AbstractQoreNode* *getMemberValuePtr(const QoreObject* obj, const char* key, AutoVLock *vl, const QoreTypeInfo*& typeInfo, ExceptionSink* xsink) {
       return obj->priv->getMemberValuePtr(key, vl, typeInfo, xsink);
    }
@@ -73,6 +73,102 @@ public:
 #define QW_DEL     -1
 #define QW_TIMEOUT -2
 
+// size of the padding used to keep the ring buffer positions on separate cache lines
+#define QORE_QUEUE_RING_PAD 64
+
+// the maximum size of a ring-buffer queue; the buffer is allocated when the queue is created
+#define QORE_QUEUE_RING_MAX 0x1000000
+
+// bounded multi-producer, multi-consumer ring buffer
+/* each cell has a sequence number telling producers and consumers whether the cell is free or filled for
+   a given position; positions are claimed with a compare-and-swap, so pushing and shifting never take a lock
+ */
+class QoreQueueRing {
+protected:
+   struct Cell {
+      size_t seq;
+      AbstractQoreNode* node;
+   };
+
+   Cell* cells;
+   size_t cap;
+   char pad0[QORE_QUEUE_RING_PAD];
+   // the next position to write
+   size_t enq_pos;
+   char pad1[QORE_QUEUE_RING_PAD];
+   // the next position to read
+   size_t deq_pos;
+   char pad2[QORE_QUEUE_RING_PAD];
+
+public:
+   DLLLOCAL QoreQueueRing(size_t n_cap) : cells(new Cell[n_cap]), cap(n_cap), enq_pos(0), deq_pos(0) {
+      for (size_t i = 0; i < cap; ++i) {
+         cells[i].seq = i;
+         cells[i].node = 0;
+      }
+   }
+
+   DLLLOCAL ~QoreQueueRing() {
+      delete [] cells;
+   }
+
+   DLLLOCAL size_t getCapacity() const {
+      return cap;
+   }
+
+   // returns the number of elements in the buffer; may be out of date when returned
+   DLLLOCAL size_t size() const {
+      size_t d = qore_atomic_load_acquire(&deq_pos);
+      size_t e = qore_atomic_load_acquire(&enq_pos);
+      return e > d ? (e - d > cap ? cap : e - d) : 0;
+   }
+
+   // adds the value to the end of the buffer and takes the reference; returns false if the buffer is full
+   DLLLOCAL bool tryPush(AbstractQoreNode* v) {
+      size_t pos = qore_atomic_load(&enq_pos);
+      Cell* c;
+      while (true) {
+         c = &cells[pos % cap];
+         size_t seq = qore_atomic_load_acquire(&c->seq);
+         qore_offset_t dif = (qore_offset_t)seq - (qore_offset_t)pos;
+         if (!dif) {
+            if (qore_atomic_cas(&enq_pos, pos, pos + 1))
+               break;
+         }
+         else if (dif < 0)
+            return false;
+         else
+            pos = qore_atomic_load(&enq_pos);
+      }
+      c->node = v;
+      qore_atomic_store_release(&c->seq, pos + 1);
+      return true;
+   }
+
+   // removes the first value in the buffer and returns it in the argument; returns false if the buffer is empty
+   DLLLOCAL bool tryShift(AbstractQoreNode*& v) {
+      size_t pos = qore_atomic_load(&deq_pos);
+      Cell* c;
+      while (true) {
+         c = &cells[pos % cap];
+         size_t seq = qore_atomic_load_acquire(&c->seq);
+         qore_offset_t dif = (qore_offset_t)seq - (qore_offset_t)(pos + 1);
+         if (!dif) {
+            if (qore_atomic_cas(&deq_pos, pos, pos + 1))
+               break;
+         }
+         else if (dif < 0)
+            return false;
+         else
+            pos = qore_atomic_load(&deq_pos);
+      }
+      v = c->node;
+      c->node = 0;
+      qore_atomic_store_release(&c->seq, pos + cap);
+      return true;
+   }
+};
+
 class qore_queue_private {
 private:
    enum queue_status_e { Queue_Deleted = -1 };
@@ -86,6 +182,9 @@ private:
        max;   // the maximum size of the queue (or -1 for unlimited)
    unsigned read_waiting,   // number of threads waiting on reads
             write_waiting;  // number of threads waiting on writes
+   // lock-free ring buffer used instead of the node list for ring-buffer queues; the lock and condition
+   // variables are then only used by threads that have to block
+   QoreQueueRing* ring;
 
    DLLLOCAL int waitReadIntern(ExceptionSink *xsink, int timeout_ms);
    DLLLOCAL int waitWriteIntern(ExceptionSink *xsink, int timeout_ms);
@@ -96,17 +195,70 @@ private:
 
    DLLLOCAL void clearIntern(ExceptionSink* xsink);
 
+   // ring buffer variants of the blocking operations
+   DLLLOCAL int waitRingReadIntern(ExceptionSink* xsink, int timeout_ms, AbstractQoreNode*& rv);
+   DLLLOCAL int waitRingWriteIntern(ExceptionSink* xsink, int timeout_ms, AbstractQoreNode* v);
+   DLLLOCAL void ringPush(ExceptionSink* xsink, const AbstractQoreNode* n, int timeout_ms, bool* to);
+   DLLLOCAL AbstractQoreNode* ringShift(ExceptionSink* xsink, int timeout_ms, bool* to);
+   DLLLOCAL void ringClear(ExceptionSink* xsink);
+
+   // wakes up threads blocked on an empty ring buffer after values have been pushed
+   DLLLOCAL void ringSignalReaders(unsigned n) {
+      // the full barrier orders the publication of the values before the check of the waiting count;
+      // blocking readers increment the count with a full barrier before checking the buffer
+      qore_atomic_fence();
+      if (qore_atomic_load(&read_waiting)) {
+         AutoLocker al(&l);
+         if (n == 1)
+            read_cond.signal();
+         else
+            read_cond.broadcast();
+      }
+   }
+
+   // wakes up threads blocked on a full ring buffer after values have been removed
+   DLLLOCAL void ringSignalWriters(unsigned n) {
+      qore_atomic_fence();
+      if (qore_atomic_load(&write_waiting)) {
+         AutoLocker al(&l);
+         if (n == 1)
+            write_cond.signal();
+         else
+            write_cond.broadcast();
+      }
+   }
+
+   // returns true if the queue has been deleted; for the lock-free ring buffer operations
+   DLLLOCAL bool ringDeleted() const {
+      return qore_atomic_load_acquire(&len) == Queue_Deleted;
+   }
+
+   DLLLOCAL int checkRingOp(ExceptionSink* xsink, const char* op) const {
+      if (ring) {
+         xsink->raiseException("QUEUE-ERROR", "Queue::%s() is not supported by ring-buffer queues", op);
+         return -1;
+      }
+      return 0;
+   }
+
 public:
-   DLLLOCAL qore_queue_private(int n_max = -1) : head(0), tail(0), len(0), max(n_max), read_waiting(0), write_waiting(0) {
+   DLLLOCAL qore_queue_private(int n_max = -1) : head(0), tail(0), len(0), max(n_max), read_waiting(0), write_waiting(0), ring(0) {
       assert(max);
       //printd(5, "qore_queue_private::qore_queue_private() this: %p max: %d\n", this, max);
    }
 
-   DLLLOCAL qore_queue_private(const qore_queue_private &orig) : head(0), tail(0), len(0), max(orig.max), read_waiting(0), write_waiting(0) {
+   DLLLOCAL qore_queue_private(const qore_queue_private &orig) : head(0), tail(0), len(0), max(orig.max), read_waiting(0), write_waiting(0), ring(0) {
+      // the elements of ring buffers cannot be read safely while other threads may remove them, so ring-buffer
+      // queues are copied without their elements
+      if (orig.ring) {
+         ring = new QoreQueueRing(orig.ring->getCapacity());
+         return;
+      }
+
       AutoLocker al(orig.l);
       if (orig.len == Queue_Deleted)
          return;
-      
+
       QoreQueueNode* w = orig.head;
       while (w) {
          pushIntern(w->node ? w->node->refSelf() : 0);
@@ -124,8 +276,33 @@ public:
       assert(!head);
       assert(!tail);
       assert(len == Queue_Deleted);
+      if (ring) {
+         // dereference any values pushed by other threads while the queue was being deleted
+         ExceptionSink xsink;
+         AbstractQoreNode* v;
+         while (ring->tryShift(v))
+            discard(v, &xsink);
+         delete ring;
+      }
+   }
+
+   // makes the queue use a lock-free ring buffer; must be called before the queue is used
+   DLLLOCAL void setRingBuffer() {
+      assert(max > 0 && max <= QORE_QUEUE_RING_MAX);
+      assert(!ring && !head);
+      ring = new QoreQueueRing(max);
    }
 
+   DLLLOCAL bool isRingBuffer() const {
+      return ring;
+   }
+
+   // push all elements of the list at the end of the queue
+   DLLLOCAL void pushBatch(ExceptionSink* xsink, const QoreListNode* l, int timeout_ms = 0, bool* to = 0);
+
+   // remove up to max elements from the beginning of the queue; blocks until at least one element is available
+   DLLLOCAL QoreListNode* getBatch(ExceptionSink* xsink, int max, int timeout_ms = 0, bool* to = 0);
+
    // push at the end of the queue and take the reference - can only be used when len == -1
    DLLLOCAL void pushAndTakeRef(AbstractQoreNode* n);
 
@@ -139,11 +316,11 @@ public:
    DLLLOCAL AbstractQoreNode* pop(ExceptionSink* xsink, int timeout_ms = 0, bool *to = 0);
 
    DLLLOCAL bool empty() const {
-      return !len;
+      return ring ? !ring->size() : !len;
    }
 
    DLLLOCAL int size() const {
-      return len;
+      return ring && len != Queue_Deleted ? (int)ring->size() : len;
    }
 
    DLLLOCAL int getMax() const {
@@ -164,6 +341,22 @@ public:
    DLLLOCAL static void destructor(QoreQueue& q, ExceptionSink* xsink) {
       q.priv->destructor(xsink);
    }
+
+   DLLLOCAL static void setRingBuffer(QoreQueue& q) {
+      q.priv->setRingBuffer();
+   }
+
+   DLLLOCAL static bool isRingBuffer(const QoreQueue& q) {
+      return q.priv->isRingBuffer();
+   }
+
+   DLLLOCAL static void pushBatch(QoreQueue& q, ExceptionSink* xsink, const QoreListNode* l, int timeout_ms = 0, bool* to = 0) {
+      q.priv->pushBatch(xsink, l, timeout_ms, to);
+   }
+
+   DLLLOCAL static QoreListNode* getBatch(QoreQueue& q, ExceptionSink* xsink, int max, int timeout_ms = 0, bool* to = 0) {
+      return q.priv->getBatch(xsink, max, timeout_ms, to);
+   }
 };
 
 #endif // _QORE_QOREQUEUEINTERN_H
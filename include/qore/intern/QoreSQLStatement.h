@@ -61,6 +61,8 @@ protected:
    bool raw;
    // valid flag
    bool validp;
+   // hash with the keys of the last row fetched and no values; used to share key tables between rows
+   QoreHashNode* row_keys;
 
    DLLLOCAL int checkStatus(ExceptionSink* xsink, DBActionHelper& dba, int stat, const char* action);
 
@@ -69,9 +71,10 @@ protected:
    DLLLOCAL int defineIntern(ExceptionSink* xsink);
    DLLLOCAL int prepareIntern(ExceptionSink* xsink);
    DLLLOCAL int prepareArgs(bool n_raw, const QoreString& n_str, const QoreListNode* args, ExceptionSink* xsink);
+   DLLLOCAL void shareRowKeys(QoreHashNode& row, ExceptionSink* xsink);
       
 public:
-   DLLLOCAL QoreSQLStatement() : dsh(0), prepare_args(0), status(STMT_IDLE), raw(false), validp(false) {
+   DLLLOCAL QoreSQLStatement() : dsh(0), prepare_args(0), status(STMT_IDLE), raw(false), validp(false), row_keys(0) {
    }
 
    DLLLOCAL ~QoreSQLStatement();
@@ -160,8 +160,6 @@ public:
 
 class QoreZoneInfo : public AbstractQoreZoneInfo {
 protected:
-   // first positive transition entry (after the epoch)
-   int first_pos;
    bool valid;
    const char *std_abbr;  // standard time abbreviation
 
@@ -169,6 +167,13 @@ protected:
    typedef std::vector<QoreDSTTransition> dst_transition_vec_t;
    dst_transition_vec_t QoreDSTTransitions;
 
+   // sorted transition times (parallel to QoreDSTTransitions) for binary searches
+   typedef std::vector<int> trans_time_vec_t;
+   trans_time_vec_t trans_times;
+
+   // index of the last band found; bands are immutable so this can be read and updated without locking
+   mutable volatile int last_band;
+
    // QoreTransitionInfo array
    trans_vec_t tti;
 
@@ -179,6 +184,9 @@ protected:
    // returns the UTC offset and local time zone name for the given time given as seconds from the epoch (1970-01-01Z)
    DLLLOCAL virtual int getUTCOffsetImpl(int64 epoch_offset, bool &is_dst, const char *&zone_name) const;
 
+   // returns the index of the transition band containing the given time or -1 if the time is outside all bands
+   DLLLOCAL int findBand(int64 epoch_offset) const;
+
 public:
    DLLLOCAL QoreZoneInfo(QoreString &root, std::string &n_name, ExceptionSink *xsink);
 
@@ -229,16 +237,105 @@ public:
 };
 #endif
 
+// time zone info map (ex: "Europe/Prague" -> QoreZoneInfo*) with lock-free lookups
+// entries are only added while holding the QoreTimeZoneManager's write lock and are never removed
+class QoreZoneInfoMap {
+protected:
+   struct Entry {
+      std::string name;
+      AbstractQoreZoneInfo* zi;
+      Entry* next;
+      // true if the entry owns the zone info object; the same object can be stored under more than one name
+      bool owner;
+
+      DLLLOCAL Entry(const std::string& n_name, AbstractQoreZoneInfo* n_zi, Entry* n_next, bool n_owner) : name(n_name), zi(n_zi), next(n_next), owner(n_owner) {
+      }
+   };
+
+   // number of hash buckets; there are about 600 regions in a full zoneinfo database
+   enum { NUM_BUCKETS = 256 };
+
+   Entry* volatile buckets[NUM_BUCKETS];
+
+   // returns true if the zone info object is already in the map
+   DLLLOCAL bool contains(const AbstractQoreZoneInfo* zi) const {
+      for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+         for (Entry* e = buckets[i]; e; e = e->next) {
+            if (e->zi == zi)
+               return true;
+         }
+      }
+      return false;
+   }
+
+   DLLLOCAL static unsigned hash(const char* name) {
+      // FNV-1a
+      unsigned h = 2166136261u;
+      while (*name) {
+         h ^= (unsigned char)*name++;
+         h *= 16777619u;
+      }
+      return h % NUM_BUCKETS;
+   }
+
+public:
+   DLLLOCAL QoreZoneInfoMap() {
+      for (unsigned i = 0; i < NUM_BUCKETS; ++i)
+         buckets[i] = 0;
+   }
+
+   // deletes all zone info objects in the map
+   DLLLOCAL ~QoreZoneInfoMap() {
+      for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+         Entry* e = buckets[i];
+         while (e) {
+            Entry* n = e->next;
+            if (e->owner)
+               delete e->zi;
+            delete e;
+            e = n;
+         }
+      }
+   }
+
+   // can be called without any lock held
+   DLLLOCAL AbstractQoreZoneInfo* find(const char* name) const {
+      for (Entry* e = buckets[hash(name)]; e; e = e->next) {
+         if (e->name == name)
+            return e->zi;
+      }
+      return 0;
+   }
+
+   // must be called with the write lock held; newer entries hide older entries with the same name; the map takes
+   // ownership of the zone info object unless it's already in the map under another name (it's deleted only once)
+   DLLLOCAL void insert(const std::string& name, AbstractQoreZoneInfo* zi) {
+      unsigned b = hash(name.c_str());
+      // an object already stored with the same name does not need a new entry
+      for (Entry* e = buckets[b]; e; e = e->next) {
+         if (e->name == name) {
+            if (e->zi == zi)
+               return;
+            break;
+         }
+      }
+      Entry* e = new Entry(name, zi, buckets[b], !contains(zi));
+      // make sure the entry and the zone info object are visible to other threads before it's published
+      qore_atomic_fence();
+      buckets[b] = e;
+   }
+};
+
 class QoreTimeZoneManager {
 protected:
-   // read-write lock to manage real (non-offset) zone info objects
+   // read-write lock to serialize loading real (non-offset) zone info objects; lookups do not need a lock
    mutable QoreRWLock rwl;
 
    // read-write lock to guard access to offset custom zone info objects
    mutable QoreRWLock rwl_offset;
 
    // time zone info map (ex: "Europe/Prague" -> QoreZoneInfo*)
-   typedef std::map<std::string, AbstractQoreZoneInfo *> tzmap_t;
+   typedef QoreZoneInfoMap tzmap_t;
 
    // offset map type
    typedef std::map<int, QoreOffsetZoneInfo *> tzomap_t;
@@ -264,6 +361,15 @@ protected:
    DLLLOCAL int processIntern(const char *fn, ExceptionSink *xsink);
    DLLLOCAL int process(const char *fn);
 
+   // returns the name used as the key in tzmap for the given file name
+   DLLLOCAL const char* getRegionKey(const char* fn) const {
+#ifndef _Q_WINDOWS
+      if (!strncmp(root.getBuffer(), fn, root.strlen()))
+         return fn + root.strlen() + 1;
+#endif
+      return fn;
+   }
+
    DLLLOCAL const AbstractQoreZoneInfo *processFile(const char *fn, bool use_path, ExceptionSink *xsink);
    DLLLOCAL int processDir(const char *d, ExceptionSink *xsink);
 
@@ -280,9 +386,6 @@ public:
    DLLLOCAL QoreTimeZoneManager();
 
    DLLLOCAL ~QoreTimeZoneManager() {
-      for (tzmap_t::iterator i = tzmap.begin(), e = tzmap.end(); i != e; ++i)
-	 delete i->second;
-
       for (tzomap_t::iterator i = tzo_std_map.begin(), e = tzo_std_map.end(); i != e; ++i) {
          //printd(0, "QoreTimeZoneManager::~QoreTimeZoneManager() deleting %d: %s\n", i->first, i->second->getRegionName());
 	 delete i->second;
@@ -293,9 +396,7 @@ public:
    }
 
    DLLLOCAL AbstractQoreZoneInfo *getZone(const char *name) {
-      QoreAutoRWReadLocker al(rwl);
-      tzmap_t::iterator i = tzmap.find(name);
-      return i == tzmap.end() ? 0 : i->second;
+      return tzmap.find(name);
    }
 
    DLLLOCAL const QoreOffsetZoneInfo *findCreateOffsetZone(int seconds_east);
@@ -89,6 +89,11 @@ public:
    DLLLOCAL const char* getCipherVersion() const;
    DLLLOCAL X509* getPeerCertificate() const;
    DLLLOCAL long verifyPeerCertificate() const;
+
+   // returns true if decrypted data is buffered in the SSL object that can be read without waiting on the socket
+   DLLLOCAL bool pending() const {
+      return ssl && SSL_pending(ssl) > 0;
+   }
 };
 
 #endif
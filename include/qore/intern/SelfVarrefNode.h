@@ -48,11 +48,13 @@ protected:
 
 public:
    char* str;
+   // slot of the member in the class member key table if the member is declared, otherwise -1
+   size_t slot;
 
-   DLLLOCAL SelfVarrefNode(char *c_str, int sline, int eline) : ParseNode(NT_SELF_VARREF), loc(sline, eline), returnTypeInfo(0), str(c_str) {
+   DLLLOCAL SelfVarrefNode(char *c_str, int sline, int eline) : ParseNode(NT_SELF_VARREF), loc(sline, eline), returnTypeInfo(0), str(c_str), slot((size_t)-1) {
    }
 
-   DLLLOCAL SelfVarrefNode(char *c_str, const QoreProgramLocation& l) : ParseNode(NT_SELF_VARREF), loc(l), returnTypeInfo(0), str(c_str) {
+   DLLLOCAL SelfVarrefNode(char *c_str, const QoreProgramLocation& l) : ParseNode(NT_SELF_VARREF), loc(l), returnTypeInfo(0), str(c_str), slot((size_t)-1) {
    }
 
    DLLLOCAL virtual ~SelfVarrefNode() {
@@ -74,6 +76,9 @@ public:
 
    // returns the string, caller owns the memory
    DLLLOCAL char* takeString();
+
+   // gets an lvalue for the member in the current object
+   DLLLOCAL int getLValue(LValueHelper& lvh, bool for_remove) const;
 };
 
 #endif
@@ -33,46 +33,155 @@
 #define QTP_DEFAULT_RELEASE_MS 5000
 
 #include <deque>
+#include <vector>
 #include <qore/qlist>
+#include <qore/QoreThreadLocalStorage.h>
+#include <qore/intern/QoreException.h>
+
+DLLLOCAL extern qore_classid_t CID_THREADPOOLFUTURE;
+DLLLOCAL extern QoreClass* QC_THREADPOOLFUTURE;
 
 class ThreadTask;
 class ThreadPoolThread;
+class ThreadPoolStealWorker;
 
 typedef std::deque<ThreadTask*> taskq_t;
 typedef qlist<ThreadPoolThread*> tplist_t;
+typedef std::vector<ThreadPoolStealWorker*> swvec_t;
+
+// the result of a task submitted with ThreadPool::submitFuture()
+class ThreadPoolFuture : public AbstractPrivateData {
+protected:
+   QoreThreadLock m;
+   QoreCondition cond;
+   // the return value of the task
+   QoreValue val;
+   // the exception raised by the task, if any
+   QoreException* ex;
+   bool done,
+      canceled;
+
+   DLLLOCAL virtual ~ThreadPoolFuture() {
+      assert(!ex);
+   }
+
+public:
+   DLLLOCAL ThreadPoolFuture() : ex(0), done(false), canceled(false) {
+   }
+
+   DLLLOCAL virtual void deref(ExceptionSink* xsink) {
+      if (ROdereference()) {
+         val.discard(xsink);
+         if (ex) {
+            ex->del(xsink);
+            ex = 0;
+         }
+         delete this;
+      }
+   }
+
+   // sets the result of the task and wakes up all waiting threads; takes ownership of the value and exceptions
+   DLLLOCAL void set(QoreValue v, ExceptionSink& xs) {
+      QoreException* e = xs.catchException();
+      AutoLocker al(m);
+      assert(!done);
+      val = v;
+      ex = e;
+      done = true;
+      cond.broadcast();
+   }
+
+   DLLLOCAL void cancel() {
+      AutoLocker al(m);
+      assert(!done);
+      canceled = done = true;
+      cond.broadcast();
+   }
+
+   DLLLOCAL bool isDone() {
+      AutoLocker al(m);
+      return done;
+   }
+
+   // waits for the task to complete and returns its value or rethrows its exception; "to" is set on timeout
+   DLLLOCAL QoreValue get(ExceptionSink* xsink, int timeout_ms, bool& to) {
+      AutoLocker al(m);
+      to = false;
+      while (!done) {
+         if (timeout_ms) {
+            if (cond.wait(m, timeout_ms)) {
+               to = true;
+               return QoreValue();
+            }
+         }
+         else
+            cond.wait(m);
+      }
+
+      if (canceled) {
+         xsink->raiseException("THREADPOOL-TASK-CANCELED", "the task was canceled because the ThreadPool was stopped before it could be executed");
+         return QoreValue();
+      }
+      if (ex) {
+         xsink->rethrow(ex);
+         return QoreValue();
+      }
+      return val.refSelf();
+   }
+};
 
 class ThreadTask {
 protected:
    ResolvedCallReferenceNode* code;
    ResolvedCallReferenceNode* cancelCode;
+   // the future receiving the result of the task, if any
+   ThreadPoolFuture* future;
    
 public:
-   DLLLOCAL ThreadTask(ResolvedCallReferenceNode* c, ResolvedCallReferenceNode* cc) : code(c), cancelCode(cc) {
+   DLLLOCAL ThreadTask(ResolvedCallReferenceNode* c, ResolvedCallReferenceNode* cc, ThreadPoolFuture* f = 0) : code(c), cancelCode(cc), future(f) {
    }
 
    DLLLOCAL ~ThreadTask() {
       assert(!code);
       assert(!cancelCode);
+      assert(!future);
    }
 
    DLLLOCAL void del(ExceptionSink* xsink) {
       code->deref(xsink);
       if (cancelCode)
          cancelCode->deref(xsink);
+      if (future)
+         future->deref(xsink);
 #ifdef DEBUG
       code = 0;
       cancelCode = 0;
+      future = 0;
 #endif
       delete this;
    }
 
-   DLLLOCAL QoreValue run(ExceptionSink* xsink) {
-      return code->execValue(0, xsink);
+   // executes the task; the result and any exception are passed to the future if there is one
+   DLLLOCAL void run(ExceptionSink* xsink) {
+      if (!future) {
+         code->execValue(0, xsink).discard(xsink);
+         return;
+      }
+
+      ExceptionSink xs;
+      QoreValue rv = code->execValue(0, &xs);
+      if (xs.isThreadExit()) {
+         rv.discard(&xs);
+         xsink->raiseThreadExit();
+      }
+      future->set(rv, xs);
    }
 
    DLLLOCAL void cancel(ExceptionSink* xsink) {
       if (cancelCode)
          cancelCode->execValue(0, xsink).discard(xsink);
+      if (future)
+         future->cancel();
    }
 };
 
@@ -181,7 +290,78 @@ public:
    }
 };
 
+// a worker thread of a work-stealing ThreadPool with its own task deque
+/* the thread owning the deque takes the most recently added task from the back; idle threads steal the oldest
+   tasks from the front of other threads' deques
+ */
+class ThreadPoolStealWorker {
+protected:
+   ThreadPool& tp;
+   // the index of the worker in the pool
+   int index;
+   // the lock protecting the deque
+   QoreThreadLock m;
+   taskq_t dq;
+
+public:
+   DLLLOCAL ThreadPoolStealWorker(ThreadPool& n_tp, int n_index) : tp(n_tp), index(n_index) {
+   }
+
+   DLLLOCAL ~ThreadPoolStealWorker() {
+      assert(dq.empty());
+   }
+
+   DLLLOCAL int getIndex() const {
+      return index;
+   }
+
+   DLLLOCAL ThreadPool& getPool() const {
+      return tp;
+   }
+
+   // adds the task unless the pool is being stopped; the flag is checked in the lock so that no task can be
+   // added after the deque has been drained when the pool is stopped
+   DLLLOCAL int push(ThreadTask* t, const bool& stopflag) {
+      AutoLocker al(m);
+      if (stopflag)
+         return -1;
+      dq.push_back(t);
+      return 0;
+   }
+
+   // takes the task added last; called only by the owning thread
+   DLLLOCAL ThreadTask* popLocal() {
+      AutoLocker al(m);
+      if (dq.empty())
+         return 0;
+      ThreadTask* t = dq.back();
+      dq.pop_back();
+      return t;
+   }
+
+   // takes the oldest task; called by other worker threads
+   DLLLOCAL ThreadTask* steal() {
+      AutoLocker al(m);
+      if (dq.empty())
+         return 0;
+      ThreadTask* t = dq.front();
+      dq.pop_front();
+      return t;
+   }
+
+   // removes all tasks from the deque
+   DLLLOCAL void drain(taskq_t& tq) {
+      AutoLocker al(m);
+      tq.insert(tq.end(), dq.begin(), dq.end());
+      dq.clear();
+   }
+
+   DLLLOCAL void worker(ExceptionSink* xsink);
+};
+
 class ThreadPool : public AbstractPrivateData {
+   friend class ThreadPoolStealWorker;
+
 protected:
    int max,        // maximum number of threads in pool (if <= 0 then unlimited)
       minidle,     // minimum number of idle threads
@@ -213,6 +393,115 @@ protected:
       stopped,      // stopped flag
       confirm;      // confirm member thread stop
 
+   // work-stealing worker threads; empty if tasks are dispatched from the master task queue
+   swvec_t sw;
+
+   // the work-stealing worker of the current thread, if any; shared by all pools, the worker gives the pool
+   static QoreThreadLocalStorage<ThreadPoolStealWorker> local_worker;
+
+   int pending;          // number of tasks in work-stealing deques
+   unsigned sleeping,    // number of work-stealing workers waiting for tasks
+      next_worker;       // the next worker for tasks submitted by other threads
+   int running;          // number of running work-stealing worker threads
+
+   DLLLOCAL int startStealWorkers(int n, ExceptionSink* xsink);
+
+   // returns a task from the worker's own deque or one stolen from another worker
+   DLLLOCAL ThreadTask* getStealTask(ThreadPoolStealWorker* w) {
+      if (stopflag)
+         return 0;
+
+      ThreadTask* t = w->popLocal();
+      if (!t) {
+         int n = sw.size();
+         for (int i = 1; i < n; ++i) {
+            t = sw[(w->getIndex() + i) % n]->steal();
+            if (t)
+               break;
+         }
+         if (!t)
+            return 0;
+      }
+      qore_atomic_fetch_sub(&pending, 1);
+      return t;
+   }
+
+   // waits for tasks to be submitted; returns -1 if the pool is being stopped
+   DLLLOCAL int waitStealTask() {
+      AutoLocker al(m);
+      if (stopflag)
+         return -1;
+      // the full barrier orders the sleep count before the check of the pending count; submitting threads
+      // update the pending count with a full barrier before checking the sleep count
+      qore_atomic_fetch_add(&sleeping, 1u);
+      if (!qore_atomic_load(&pending))
+         cond.wait(m);
+      qore_atomic_fetch_sub(&sleeping, 1u);
+      return stopflag ? -1 : 0;
+   }
+
+   DLLLOCAL void stealWorkerDone(ExceptionSink* xsink) {
+      {
+         AutoLocker al(m);
+         if (!--running)
+            stopCond.broadcast();
+      }
+      deref(xsink);
+   }
+
+   DLLLOCAL int submitSteal(ThreadTask* t, ExceptionSink* xsink) {
+      ThreadTaskHolder task(t, xsink);
+
+      // tasks submitted by a worker thread of this pool go to the worker's own deque
+      ThreadPoolStealWorker* w = local_worker.get();
+      if (!w || &w->getPool() != this)
+         w = sw[qore_atomic_fetch_add(&next_worker, 1u) % sw.size()];
+
+      if (w->push(t, stopflag)) {
+         xsink->raiseException("THREADPOOL-ERROR", "ThreadPool::submit() cannot be executed because the ThreadPool is being destroyed");
+         return -1;
+      }
+      task.release();
+
+      qore_atomic_fetch_add(&pending, 1);
+      if (qore_atomic_load(&sleeping)) {
+         AutoLocker al(m);
+         cond.signal();
+      }
+      return 0;
+   }
+
+   // stops a work-stealing pool; pending tasks are canceled in the calling thread
+   DLLLOCAL void stopSteal(bool wait, ExceptionSink* xsink) {
+      {
+         AutoLocker al(m);
+         if (!stopflag) {
+            stopflag = true;
+            confirm = wait;
+            cond.broadcast();
+         }
+         if (wait) {
+            while (running)
+               stopCond.wait(m);
+         }
+      }
+
+      taskq_t tq;
+      for (swvec_t::iterator i = sw.begin(), e = sw.end(); i != e; ++i)
+         (*i)->drain(tq);
+      if (!tq.empty())
+         qore_atomic_fetch_sub(&pending, (int)tq.size());
+
+      for (taskq_t::iterator i = tq.begin(), e = tq.end(); i != e; ++i) {
+         (*i)->cancel(xsink);
+         (*i)->del(xsink);
+      }
+
+      AutoLocker al(m);
+      stopped = true;
+      stopCond.broadcast();
+   }
+
    DLLLOCAL int checkStopUnlocked(const char* m, ExceptionSink* xsink) {
       if (stopflag) {
 	 xsink->raiseException("THREADPOOL-ERROR", "ThreadPool::%s() cannot be executed because the ThreadPool is being destroyed", m);
@@ -270,18 +559,30 @@ protected:
    }
 
 public:
-   DLLLOCAL ThreadPool(ExceptionSink* xsink, int n_max = 0, int n_minidle = 0, int m_maxidle = 0, int n_release_ms = QTP_DEFAULT_RELEASE_MS);
+   DLLLOCAL ThreadPool(ExceptionSink* xsink, int n_max = 0, int n_minidle = 0, int m_maxidle = 0, int n_release_ms = QTP_DEFAULT_RELEASE_MS, bool n_steal = false);
 
    DLLLOCAL ~ThreadPool() {
       assert(q.empty());
       assert(ah.empty());
       assert(fh.empty());
       assert(stopped);
+      assert(!running);
+      for (swvec_t::iterator i = sw.begin(), e = sw.end(); i != e; ++i)
+         delete *i;
+   }
+
+   DLLLOCAL bool isWorkStealing() const {
+      return !sw.empty();
    }
 
    DLLLOCAL void toString(QoreString& str) {
       AutoLocker al(m);
       
+      if (!sw.empty()) {
+         str.sprintf("ThreadPool %p work-stealing threads: %d running: %d pending tasks: %d idle: %d", this, (int)sw.size(), running, pending, sleeping);
+         return;
+      }
+
       str.sprintf("ThreadPool %p total: %d max: %d minidle: %d maxidle: %d release_ms: %d running: [", this, ah.size() + fh.size(), max, minidle, maxidle, release_ms);
       for (tplist_t::iterator i = ah.begin(), e = ah.end(); i != e; ++i) {
 	 if (i != ah.begin())
@@ -301,7 +602,12 @@ public:
    }
 
    // does not return until the thread pool has been stopped
-   DLLLOCAL void stop() {
+   DLLLOCAL void stop(ExceptionSink* xsink) {
+      if (!sw.empty()) {
+         stopSteal(false, xsink);
+         return;
+      }
+
       AutoLocker al(m);
       if (!stopflag) {
 	 stopflag = true;
@@ -313,12 +619,18 @@ public:
    }
 
    DLLLOCAL int stopWait(ExceptionSink* xsink) {
-      AutoLocker al(m);
+      SafeLocker sl(m);
       if (stopflag && !confirm) {
 	 xsink->raiseException("THREADPOOL-ERROR", "cannot call ThreadPool::stopWait() after ()ThreadPool::stop() has been called since child threads have been detached and can no longer be traced");
 	 return -1;
       }
 
+      if (!sw.empty()) {
+         sl.unlock();
+         stopSteal(true, xsink);
+         return 0;
+      }
+
       if (!stopflag) {
 	 stopflag = true;
 	 confirm = true;
@@ -331,9 +643,12 @@ public:
       return 0;
    }
 
-   DLLLOCAL int submit(ResolvedCallReferenceNode* c, ResolvedCallReferenceNode* cc, ExceptionSink* xsink) {
+   DLLLOCAL int submit(ResolvedCallReferenceNode* c, ResolvedCallReferenceNode* cc, ExceptionSink* xsink, ThreadPoolFuture* f = 0) {
+      if (!sw.empty())
+         return submitSteal(new ThreadTask(c, cc, f), xsink);
+
       // optimistically create the task object outside the lock
-      ThreadTaskHolder task(new ThreadTask(c, cc), xsink);
+      ThreadTaskHolder task(new ThreadTask(c, cc, f), xsink);
 
       AutoLocker al(m);
       if (checkStopUnlocked("submit", xsink))
@@ -346,10 +661,15 @@ public:
       return 0;
    }
 
-   DLLLOCAL void threadCounts(int& idle, int& running) {
+   DLLLOCAL void threadCounts(int& idle, int& n_running) {
       AutoLocker al(m);
+      if (!sw.empty()) {
+         idle = sleeping;
+         n_running = running - sleeping;
+         return;
+      }
       idle = fh.size();
-      running = ah.size();
+      n_running = ah.size();
    }
 
    DLLLOCAL int done(ThreadPoolThread* tpt) {
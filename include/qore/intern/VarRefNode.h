@@ -47,6 +47,7 @@ protected:
    qore_var_t type : 4;
    bool new_decl : 1;       // is this a new variable declaration
    bool explicit_scope : 1; // scope was explicitly provided
+   mutable int lvar_hint;   // local variable stack slot hint for this access site; -1 = not yet known; accessed atomically
 
    DLLLOCAL ~VarRefNode() {
       //printd(5, "VarRefNode::~VarRefNode() deleting variable reference %p %s\n", this, name.ostr ? name.ostr : "<taken>");
@@ -92,24 +93,24 @@ protected:
       type = VT_CLOSURE;
    }
 
-   DLLLOCAL VarRefNode(char* n, ClosureVarValue* cvv) : ParseNode(NT_VARREF, true, false), loc(RunTimeLocation), name(n), type(VT_IMMEDIATE), new_decl(false), explicit_scope(false) {
+   DLLLOCAL VarRefNode(char* n, ClosureVarValue* cvv) : ParseNode(NT_VARREF, true, false), loc(RunTimeLocation), name(n), type(VT_IMMEDIATE), new_decl(false), explicit_scope(false), lvar_hint(-1) {
       ref.cvv = cvv;
       cvv->ref();
    }
 
-   DLLLOCAL VarRefNode(const QoreProgramLocation& nloc, char* n, qore_var_t t, bool n_has_effect = false) : ParseNode(NT_VARREF, true, n_has_effect), loc(nloc), name(n), type(t), new_decl(t == VT_LOCAL), explicit_scope(false) {
+   DLLLOCAL VarRefNode(const QoreProgramLocation& nloc, char* n, qore_var_t t, bool n_has_effect = false) : ParseNode(NT_VARREF, true, n_has_effect), loc(nloc), name(n), type(t), new_decl(t == VT_LOCAL), explicit_scope(false), lvar_hint(-1) {
       if (type == VT_LOCAL)
          ref.id = 0;
       assert(type != VT_GLOBAL);
    }
 
-   DLLLOCAL VarRefNode(int sl, int el, char* n, qore_var_t t, bool n_has_effect = false) : ParseNode(NT_VARREF, true, n_has_effect), loc(sl, el), name(n), type(t), new_decl(t == VT_LOCAL), explicit_scope(false) {
+   DLLLOCAL VarRefNode(int sl, int el, char* n, qore_var_t t, bool n_has_effect = false) : ParseNode(NT_VARREF, true, n_has_effect), loc(sl, el), name(n), type(t), new_decl(t == VT_LOCAL), explicit_scope(false), lvar_hint(-1) {
       if (type == VT_LOCAL)
          ref.id = 0;
       assert(type != VT_GLOBAL);
    }
 
-   DLLLOCAL VarRefNode(char* n, Var* n_var, bool n_has_effect = false, bool n_new_decl = true) : ParseNode(NT_VARREF, true, n_has_effect), loc(ParseLocation), name(n), type(VT_GLOBAL), new_decl(n_new_decl), explicit_scope(false) {
+   DLLLOCAL VarRefNode(char* n, Var* n_var, bool n_has_effect = false, bool n_new_decl = true) : ParseNode(NT_VARREF, true, n_has_effect), loc(ParseLocation), name(n), type(VT_GLOBAL), new_decl(n_new_decl), explicit_scope(false), lvar_hint(-1) {
       ref.var = n_var;
    }
 
@@ -121,13 +122,13 @@ public:
    } ref;
 
    // takes over memory for "n"
-   DLLLOCAL VarRefNode(char* n, qore_var_t t, bool n_has_effect = false) : ParseNode(NT_VARREF, true, n_has_effect), loc(ParseLocation), name(n), type(t), new_decl(t == VT_LOCAL), explicit_scope(false) {
+   DLLLOCAL VarRefNode(char* n, qore_var_t t, bool n_has_effect = false) : ParseNode(NT_VARREF, true, n_has_effect), loc(ParseLocation), name(n), type(t), new_decl(t == VT_LOCAL), explicit_scope(false), lvar_hint(-1) {
       if (type == VT_LOCAL)
          ref.id = 0;
       assert(type != VT_GLOBAL);
    }
 
-   DLLLOCAL VarRefNode(char* n, LocalVar* n_id, bool in_closure) : ParseNode(NT_VARREF, true, false), loc(ParseLocation), name(n), new_decl(false), explicit_scope(false) {
+   DLLLOCAL VarRefNode(char* n, LocalVar* n_id, bool in_closure) : ParseNode(NT_VARREF, true, false), loc(ParseLocation), name(n), new_decl(false), explicit_scope(false), lvar_hint(-1) {
       ref.id = n_id;
       if (in_closure)
          setClosureIntern();
@@ -176,7 +177,7 @@ public:
 
    DLLLOCAL bool isRef() const {
       if (type == VT_LOCAL)
-         return ref.id->isRef();
+         return ref.id->isRef(lvar_hint);
       if (type == VT_IMMEDIATE)
          return true;
       assert(type == VT_GLOBAL);
@@ -33,6 +33,18 @@
 
 #define QORE_QL_COMPRESSION_H
 
+#ifndef QORE_BZ2_WORK_FACTOR
+#define QORE_BZ2_WORK_FACTOR 30
+#endif
+
+#ifndef QORE_BZ2_VERBOSITY
+#define QORE_BZ2_VERBOSITY 0
+#endif
+
+#ifndef BZ2_DEFAULT_COMPRESSION
+#define BZ2_DEFAULT_COMPRESSION 3
+#endif
+
 DLLLOCAL void init_compression_functions(QoreNamespace& ns);
 
 #endif
@@ -0,0 +1,187 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+  qore_atomic.h
+
+  atomic operations for lock-free internal data structures
+
+  Qore Programming Language
+
+  Copyright (C) 2003 - 2015 David Nichols
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+  DEALINGS IN THE SOFTWARE.
+
+  Note that the Qore library is released under a choice of three open-source
+  licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+  information.
+*/
+
+#ifndef _QORE_INTERN_QORE_ATOMIC_H
+#define _QORE_INTERN_QORE_ATOMIC_H
+
+#include <qore/macros.h>
+#include <qore/QoreThreadLock.h>
+
+// extends the atomic increment and decrement macros in <qore/macros.h> with the loads, stores, read-modify-write
+// operations and memory barriers needed by lock-free internal data structures
+
+// the operations are implemented with compiler builtins on platforms with atomic macros when the compiler supports
+// them; on all other platforms they are implemented with locks, like the reference counts in QoreReferenceCounter
+#if defined(HAVE_ATOMIC_MACROS) && defined(__GNUC__) && defined(__ATOMIC_ACQUIRE) && !defined(QORE_NO_ATOMIC_BUILTINS)
+
+// set if the operations below are lock-free; code that only uses lock-free algorithms to avoid locking can use
+// its locked paths when this is not defined
+#define HAVE_QORE_ATOMIC_BUILTINS
+
+// returns the value without ordering other memory accesses
+template <typename T>
+DLLLOCAL inline T qore_atomic_load(const T* p) {
+   return __atomic_load_n(p, __ATOMIC_RELAXED);
+}
+
+// returns the value; memory accesses after the load cannot be moved before it
+template <typename T>
+DLLLOCAL inline T qore_atomic_load_acquire(const T* p) {
+   return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+// sets the value without ordering other memory accesses
+template <typename T>
+DLLLOCAL inline void qore_atomic_store(T* p, T v) {
+   __atomic_store_n(p, v, __ATOMIC_RELAXED);
+}
+
+// sets the value; memory accesses before the store cannot be moved after it
+template <typename T>
+DLLLOCAL inline void qore_atomic_store_release(T* p, T v) {
+   __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+// adds the value and returns the previous value; a full memory barrier
+template <typename T>
+DLLLOCAL inline T qore_atomic_fetch_add(T* p, T v) {
+   return __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST);
+}
+
+// subtracts the value and returns the previous value; a full memory barrier
+template <typename T>
+DLLLOCAL inline T qore_atomic_fetch_sub(T* p, T v) {
+   return __atomic_fetch_sub(p, v, __ATOMIC_SEQ_CST);
+}
+
+// sets the value to "desired" if it's equal to "expected" and returns true, otherwise stores the current value in
+// "expected" and returns false; does not order other memory accesses
+template <typename T>
+DLLLOCAL inline bool qore_atomic_cas(T* p, T& expected, T desired) {
+   return __atomic_compare_exchange_n(p, &expected, desired, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+// loads before the barrier cannot be moved after any memory access after it
+DLLLOCAL inline void qore_atomic_fence_acquire() {
+   __atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+// stores after the barrier cannot be moved before any memory access before it
+DLLLOCAL inline void qore_atomic_fence_release() {
+   __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+// full memory barrier
+DLLLOCAL inline void qore_atomic_fence() {
+   __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+#else
+
+// returns the lock guarding atomic operations on the given address
+DLLLOCAL QoreThreadLock& qore_atomic_lock(const volatile void* p);
+
+// locks and unlocks a single global lock; all barriers are ordered with each other through this lock
+DLLLOCAL void qore_atomic_fence();
+
+template <typename T>
+DLLLOCAL inline T qore_atomic_load(const T* p) {
+   AutoLocker al(qore_atomic_lock(p));
+   return *p;
+}
+
+template <typename T>
+DLLLOCAL inline T qore_atomic_load_acquire(const T* p) {
+   AutoLocker al(qore_atomic_lock(p));
+   return *p;
+}
+
+template <typename T>
+DLLLOCAL inline void qore_atomic_store(T* p, T v) {
+   AutoLocker al(qore_atomic_lock(p));
+   *p = v;
+}
+
+template <typename T>
+DLLLOCAL inline void qore_atomic_store_release(T* p, T v) {
+   AutoLocker al(qore_atomic_lock(p));
+   *p = v;
+}
+
+// the read-modify-write operations are followed by a barrier, so they are full barriers as with the builtins
+template <typename T>
+DLLLOCAL inline T qore_atomic_fetch_add(T* p, T v) {
+   T rv;
+   {
+      AutoLocker al(qore_atomic_lock(p));
+      rv = *p;
+      *p = rv + v;
+   }
+   qore_atomic_fence();
+   return rv;
+}
+
+template <typename T>
+DLLLOCAL inline T qore_atomic_fetch_sub(T* p, T v) {
+   T rv;
+   {
+      AutoLocker al(qore_atomic_lock(p));
+      rv = *p;
+      *p = rv - v;
+   }
+   qore_atomic_fence();
+   return rv;
+}
+
+template <typename T>
+DLLLOCAL inline bool qore_atomic_cas(T* p, T& expected, T desired) {
+   AutoLocker al(qore_atomic_lock(p));
+   if (*p == expected) {
+      *p = desired;
+      return true;
+   }
+   expected = *p;
+   return false;
+}
+
+DLLLOCAL inline void qore_atomic_fence_acquire() {
+   qore_atomic_fence();
+}
+
+DLLLOCAL inline void qore_atomic_fence_release() {
+   qore_atomic_fence();
+}
+
+#endif
+
+#endif
@@ -32,6 +32,8 @@
 #ifndef _QORE_QORE_DBI_PRIVATE_H
 #define _QORE_QORE_DBI_PRIVATE_H
 
+#include <qore/intern/QoreHashNodeIntern.h>
+
 #include <map>
 
 // internal DBI definitions
@@ -179,7 +181,11 @@ struct qore_dbi_private {
 
    DLLLOCAL AbstractQoreNode* selectRows(Datasource* ds, const QoreString* sql, const QoreListNode* args, ExceptionSink* xsink) const {
       DbiArgHelper dargs(args, (caps & DBI_CAP_HAS_NUMBER_SUPPORT), xsink);
-      return f.selectRows(ds, sql, *dargs, xsink);
+      AbstractQoreNode* rv = f.selectRows(ds, sql, *dargs, xsink);
+      // make rows with the same columns share one key table
+      if (get_node_type(rv) == NT_LIST)
+         qore_hash_private::shareKeys(*reinterpret_cast<QoreListNode*>(rv));
+      return rv;
    }
 
    DLLLOCAL QoreHashNode* selectRow(Datasource* ds, const QoreString* sql, const QoreListNode* args, ExceptionSink* xsink) const {
@@ -318,7 +324,11 @@ struct qore_dbi_private {
    }
 
    DLLLOCAL QoreListNode* stmt_fetch_rows(SQLStatement* stmt, int rows, ExceptionSink* xsink) const {
-      return f.stmt.fetch_rows(stmt, rows, xsink);
+      QoreListNode* rv = f.stmt.fetch_rows(stmt, rows, xsink);
+      // make rows with the same columns share one key table
+      if (rv)
+         qore_hash_private::shareKeys(*rv);
+      return rv;
    }
 
    DLLLOCAL QoreHashNode* stmt_fetch_columns(SQLStatement* stmt, int rows, ExceptionSink* xsink) const {
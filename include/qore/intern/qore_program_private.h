@@ -169,6 +169,47 @@ public:
       // to avoid a warning on most compilers - note that this generates a warning on recent versions of aCC!
       return 0;
    }
+
+   // finds a local variable with a slot hint: "hint" is the offset of the variable from the top of the stack
+   // as seen from a particular access site; the lexical layout of the stack is fixed for any given access
+   // site, so the hint is checked directly and only on a mismatch is the stack searched and the hint updated;
+   // the hint is shared by all threads executing the access site, so it is only accessed with relaxed atomic
+   // operations: any value read is either -1 or a valid offset, and a wrong offset is caught by the check below
+   DLLLOCAL LocalVarValue* find(const char* id, int& hint) {
+      int h = qore_atomic_load(&hint);
+      if (h >= 0) {
+         Block* w = curr;
+         int p = w->pos - 1 - h;
+         while (p < 0 && (w = w->prev))
+            p += QORE_THREAD_STACK_BLOCK;
+         if (w && w->var[p].id == id && !w->var[p].skip) {
+            assert(&w->var[p] == find(id));
+            return &w->var[p];
+         }
+      }
+
+      // the hint is only updated if no skipped entry for the same variable was found above the match
+      Block* w = curr;
+      h = 0;
+      while (true) {
+         int p = w->pos;
+         while (p) {
+            if (w->var[--p].id == id) {
+               if (!w->var[p].skip) {
+                  if (h >= 0)
+                     qore_atomic_store(&hint, h);
+                  return &w->var[p];
+               }
+               h = -1;
+            }
+            if (h >= 0)
+               ++h;
+         }
+         w = w->prev;
+         assert(w);
+      }
+      return 0;
+   }
 };
 
 class ThreadClosureVariableStack : public ThreadLocalData<ClosureVarValue*> {
@@ -44,6 +44,10 @@
 #include <errno.h>
 #include <sys/file.h>
 
+#ifdef HAVE_POLL_H
+#include <poll.h>
+#endif
+
 #ifdef HAVE_SYS_SELECT_H
 #include <sys/select.h>
 #endif
@@ -54,6 +58,16 @@
 #define DEFAULT_FILE_BUFSIZE 16384
 #endif
 
+// default size of the userspace read buffer used for line and character reads
+#ifndef DEFAULT_FILE_READ_BUFSIZE
+#define DEFAULT_FILE_READ_BUFSIZE 65536
+#endif
+
+// maximum size of the userspace read buffer
+#ifndef QORE_MAX_FILE_READ_BUFSIZE
+#define QORE_MAX_FILE_READ_BUFSIZE (16 * 1024 * 1024)
+#endif
+
 struct qore_qf_private {
    int fd;
    bool is_open;
@@ -62,15 +76,27 @@ struct qore_qf_private {
    std::string filename;
    mutable QoreThreadLock m;
    Queue* cb_queue;
+   // userspace read buffer; allocated on demand
+   mutable char* rbuf;
+   // size of the read buffer; 0 = unbuffered reads
+   qore_size_t rbuf_size;
+   // offset of the next unread byte and end of valid data in the read buffer
+   mutable qore_size_t rbuf_pos, rbuf_len;
 
    DLLLOCAL qore_qf_private(const QoreEncoding* cs) : is_open(false),
 						      special_file(false),
 						      charset(cs), 
-						      cb_queue(0) {
+						      cb_queue(0),
+						      rbuf(0),
+						      rbuf_size(DEFAULT_FILE_READ_BUFSIZE),
+						      rbuf_pos(0),
+						      rbuf_len(0) {
    }
 
    DLLLOCAL ~qore_qf_private() {
       close_intern();
+      if (rbuf)
+         free(rbuf);
 
       // must be dereferenced and removed before deleting
       assert(!cb_queue);
@@ -78,6 +104,7 @@ struct qore_qf_private {
 
    DLLLOCAL int close_intern() {
       filename.clear();
+      rbuf_pos = rbuf_len = 0;
 
       int rc;
       if (is_open) {
@@ -160,6 +187,10 @@ struct qore_qf_private {
       return is_open;
    }
 
+   DLLLOCAL static qore_qf_private* get(QoreFile& f) {
+      return f.priv;
+   }
+
    DLLLOCAL bool isDataAvailable(int timeout_ms, ExceptionSink* xsink) const {
       AutoLocker al(m);
 
@@ -171,13 +202,31 @@ struct qore_qf_private {
 
    // assumes lock is held and file is open
    DLLLOCAL bool isDataAvailableIntern(int timeout_ms) const {
+      // data already buffered can be returned immediately
+      if (rbuf_pos < rbuf_len)
+         return true;
+
+      int rc;
+#ifdef HAVE_POLL_H
+      // poll() has no limit on the descriptor value, unlike select() with FD_SETSIZE
+      struct pollfd pfd;
+      pfd.fd = fd;
+      pfd.events = POLLIN;
+      pfd.revents = 0;
+
+      while (true) {
+	 rc = poll(&pfd, 1, timeout_ms);
+	 // retry if we were interrupted by a signal
+	 if (rc >= 0 || errno != EINTR)
+	    break;
+      }
+#else
       fd_set sfs;
       
       FD_ZERO(&sfs);
       FD_SET(fd, &sfs);
 
       struct timeval tv;
-      int rc;
       while (true) {
 	 tv.tv_sec  = timeout_ms / 1000;
 	 tv.tv_usec = (timeout_ms % 1000) * 1000;
@@ -187,6 +236,7 @@ struct qore_qf_private {
 	 if (rc >= 0 || errno != EINTR)
 	    break;
       }
+#endif
       return rc;
    }
 
@@ -210,8 +260,8 @@ struct qore_qf_private {
    }
 #endif
 
-   // unlocked, assumes file is open
-   DLLLOCAL qore_size_t read(void *buf, qore_size_t bs) const {
+   // unlocked, assumes file is open; reads directly from the file descriptor
+   DLLLOCAL qore_offset_t readUnbuffered(void *buf, qore_size_t bs) const {
       qore_offset_t rc;
       while (true) {
 	 rc = ::read(fd, buf, bs);
@@ -226,8 +276,142 @@ struct qore_qf_private {
       return rc;
    }
 
+   // unlocked, assumes file is open and the read buffer is enabled and empty
+   // returns the number of bytes now available in the buffer, 0 for EOF, or -1 for error (errno is set to ENOMEM
+   // if the buffer cannot be allocated)
+   DLLLOCAL qore_offset_t fillReadBuffer() const {
+      assert(rbuf_size);
+      assert(rbuf_pos == rbuf_len);
+
+      if (!rbuf) {
+         rbuf = (char*)malloc(sizeof(char) * rbuf_size);
+         if (!rbuf) {
+            errno = ENOMEM;
+            return -1;
+         }
+      }
+
+      rbuf_pos = rbuf_len = 0;
+      qore_offset_t rc = readUnbuffered(rbuf, rbuf_size);
+      if (rc > 0)
+         rbuf_len = rc;
+      return rc;
+   }
+
+   // unlocked, assumes file is open
+   DLLLOCAL qore_size_t read(void *buf, qore_size_t bs) const {
+      if (!rbuf_size)
+         return readUnbuffered(buf, bs);
+
+      qore_size_t br = 0;
+      while (br < bs) {
+         qore_size_t av = rbuf_len - rbuf_pos;
+         if (!av) {
+            // large reads bypass the buffer
+            if (bs - br >= rbuf_size) {
+               qore_offset_t rc = readUnbuffered((char*)buf + br, bs - br);
+               if (rc <= 0)
+                  return br ? br : rc;
+               br += rc;
+               break;
+            }
+
+            qore_offset_t rc = fillReadBuffer();
+            if (rc <= 0)
+               return br ? br : rc;
+            av = rc;
+         }
+
+         if (av > bs - br)
+            av = bs - br;
+         memcpy((char*)buf + br, rbuf + rbuf_pos, av);
+         rbuf_pos += av;
+         br += av;
+      }
+
+      return br;
+   }
+
+   // unlocked, assumes file is open; moves the file position back to the logical read position and discards any buffered data
+   // returns 0 for OK, -1 if the file is not seekable, in which case the buffered data is retained
+   DLLLOCAL int discardReadBuffer() const {
+      qore_size_t av = rbuf_len - rbuf_pos;
+      if (av && lseek(fd, -(qore_offset_t)av, SEEK_CUR) < 0)
+         return -1;
+      rbuf_pos = rbuf_len = 0;
+      return 0;
+   }
+
+   // unlocked, assumes file is open and the read buffer is empty; stores data already read in the read buffer so
+   // that it's returned by the next read; returns true if the data was stored, false if it does not fit
+   DLLLOCAL bool pushBack(const char* data, qore_size_t len) const {
+      assert(rbuf_pos == rbuf_len);
+      if (len > rbuf_size)
+         return false;
+      if (!rbuf) {
+         rbuf = (char*)malloc(sizeof(char) * rbuf_size);
+         if (!rbuf)
+            return false;
+      }
+      memcpy(rbuf, data, len);
+      rbuf_pos = 0;
+      rbuf_len = len;
+      return true;
+   }
+
+   // unlocked, assumes file is open; pushes back the last "len" bytes read
+   DLLLOCAL void unread(qore_size_t len) const {
+      if (rbuf_size && rbuf_pos >= len) {
+         rbuf_pos -= len;
+         return;
+      }
+
+      lseek(fd, -(qore_offset_t)(len + rbuf_len - rbuf_pos), SEEK_CUR);
+      rbuf_pos = rbuf_len = 0;
+   }
+
+   DLLLOCAL int setReadBufferSize(qore_size_t size, ExceptionSink* xsink) {
+      if (size > QORE_MAX_FILE_READ_BUFSIZE) {
+         xsink->raiseException("FILE-READ-BUFFER-ERROR", "the read buffer size cannot exceed %d bytes (value passed: "QLLD")", QORE_MAX_FILE_READ_BUFSIZE, (int64)size);
+         return -1;
+      }
+
+      // allocate the new buffer here so that an allocation failure can be reported
+      char* nbuf = 0;
+      if (size) {
+         nbuf = (char*)malloc(sizeof(char) * size);
+         if (!nbuf) {
+            xsink->outOfMemory();
+            return -1;
+         }
+      }
+
+      AutoLocker al(m);
+
+      if (is_open && discardReadBuffer()) {
+         qore_size_t av = rbuf_len - rbuf_pos;
+         xsink->raiseErrnoException("FILE-READ-BUFFER-ERROR", errno, "cannot change the read buffer size while "QLLD" byte%s of data are buffered for a non-seekable file", av, av == 1 ? "" : "s");
+         free(nbuf);
+         return -1;
+      }
+
+      if (rbuf)
+         free(rbuf);
+      rbuf = nbuf;
+      rbuf_size = size;
+      return 0;
+   }
+
+   DLLLOCAL qore_size_t getReadBufferSize() const {
+      return rbuf_size;
+   }
+
    // unlocked, assumes file is open
    DLLLOCAL qore_size_t write(const void* buf, qore_size_t len, ExceptionSink* xsink = 0) const {
+      // make sure data is written at the logical file position
+      if (rbuf_pos < rbuf_len)
+         discardReadBuffer();
+
       qore_offset_t rc;
       while (true) {
 	 rc = ::write(fd, buf, len);
@@ -246,6 +430,12 @@ struct qore_qf_private {
 
    // private function, unlocked
    DLLLOCAL int readChar() const {
+      if (rbuf_size) {
+         if (rbuf_pos == rbuf_len && fillReadBuffer() <= 0)
+            return -1;
+         return (unsigned char)rbuf[rbuf_pos++];
+      }
+
       unsigned char ch = 0;
       if (read(&ch, 1) != 1)
 	 return -1;
@@ -281,14 +471,38 @@ struct qore_qf_private {
    DLLLOCAL char* readBlock(qore_offset_t &size, int timeout_ms, ExceptionSink* xsink) {
       qore_size_t bs = size > 0 && size < DEFAULT_FILE_BUFSIZE ? size : DEFAULT_FILE_BUFSIZE;
       qore_size_t br = 0;
-      char* buf = (char* )malloc(sizeof(char) * bs);
       char* bbuf = 0;
 
+      // return any data already buffered first
+      qore_size_t av = rbuf_len - rbuf_pos;
+      if (av) {
+         if (size > 0 && (qore_size_t)size < av)
+            av = size;
+         bbuf = (char* )malloc(sizeof(char) * (av + 1));
+         memcpy(bbuf, rbuf + rbuf_pos, av);
+         rbuf_pos += av;
+         br = av;
+
+         if (size > 0) {
+            if (br >= (qore_size_t)size) {
+               size = br;
+               return bbuf;
+            }
+            if (size - br < bs)
+               bs = size - br;
+         }
+      }
+
+      char* buf = (char* )malloc(sizeof(char) * bs);
+
       while (true) {
 	 // wait for data
 	 if (timeout_ms >= 0 && !isDataAvailableIntern(timeout_ms)) {
 	    xsink->raiseException("FILE-READ-TIMEOUT", "timeout limit exceeded (%d ms) reading file block", timeout_ms);
-	    br = 0;
+	    // push any data already read back into the (now empty) read buffer so it's returned by the next read;
+	    // if it does not fit, it's returned with the exception
+	    if (br && pushBack(bbuf, br))
+	       br = 0;
 	    break;
 	 }
 
@@ -349,7 +563,8 @@ struct qore_qf_private {
       if (!is_open)
          return -2;
 
-      bool tty = (bool)isatty(fd);
+      if (rbuf_size)
+         return readLineBuffered(str, incl_eol);
 
       int ch, rc = -1;
 
@@ -360,7 +575,7 @@ struct qore_qf_private {
 
          if (ch == '\r') {
             // see if next byte is \n' if we're not connected to a terminal device
-            if (!tty) {
+            if (!isatty(fd)) {
                ch = readChar();
                if (ch >= 0) {
                   if (ch == '\n') {
@@ -369,7 +584,7 @@ struct qore_qf_private {
                   }
                   else {
                      // reset file to previous byte position
-                     lseek(fd, -1, SEEK_CUR);
+                     unread(1);
                   }
                }
             }
@@ -388,6 +603,71 @@ struct qore_qf_private {
       return rc;
    }
 
+   // unlocked, assumes file is open and the read buffer is enabled
+   // scans the buffer for EOL markers with memchr() instead of processing the input byte by byte
+   DLLLOCAL int readLineBuffered(QoreString& str, bool incl_eol) {
+      int rc = -1;
+
+      while (rbuf_pos < rbuf_len || fillReadBuffer() > 0) {
+         rc = 0;
+
+         const char* start = rbuf + rbuf_pos;
+         qore_size_t av = rbuf_len - rbuf_pos;
+
+         // find the first EOL character in the buffer
+         const char* p = (const char*)memchr(start, '\n', av);
+         const char* cr = (const char*)memchr(start, '\r', p ? p - start : av);
+         if (cr)
+            p = cr;
+
+         if (!p) {
+            str.concat(start, av);
+            rbuf_pos = rbuf_len;
+            continue;
+         }
+
+         qore_size_t len = p - start;
+         str.concat(start, incl_eol ? len + 1 : len);
+         rbuf_pos += len + 1;
+
+         // see if next byte is \n' if we're not connected to a terminal device
+         if (*p == '\r' && !isatty(fd) && (rbuf_pos < rbuf_len || fillReadBuffer() > 0) && rbuf[rbuf_pos] == '\n') {
+            if (incl_eol)
+               str.concat('\n');
+            ++rbuf_pos;
+         }
+         break;
+      }
+
+      return rc;
+   }
+
+   // unlocked, assumes file is open and the read buffer is enabled
+   DLLLOCAL int readUntilBuffered(char byte, QoreString& str, bool incl_byte) {
+      int rc = -1;
+
+      while (rbuf_pos < rbuf_len || fillReadBuffer() > 0) {
+         rc = 0;
+
+         const char* start = rbuf + rbuf_pos;
+         qore_size_t av = rbuf_len - rbuf_pos;
+
+         const char* p = (const char*)memchr(start, byte, av);
+         if (!p) {
+            str.concat(start, av);
+            rbuf_pos = rbuf_len;
+            continue;
+         }
+
+         qore_size_t len = p - start;
+         str.concat(start, incl_byte ? len + 1 : len);
+         rbuf_pos += len + 1;
+         break;
+      }
+
+      return rc;
+   }
+
    DLLLOCAL int readUntil(char byte, QoreString& str, bool incl_byte = true) {
       str.clear();
 
@@ -396,6 +676,9 @@ struct qore_qf_private {
       if (!is_open)
          return -2;
 
+      if (rbuf_size)
+         return readUntilBuffered(byte, str, incl_byte);
+
       int ch, rc = -1;
 
       while ((ch = readChar()) >= 0) {
@@ -434,8 +717,6 @@ struct qore_qf_private {
       if (!is_open)
          return -2;
 
-      bool tty = (bool)isatty(fd);
-
       int ch, rc = -1;
 
       while ((ch = readUnicode()) >= 0) {
@@ -456,7 +737,7 @@ struct qore_qf_private {
 	 
          if (c == '\r') {
             // see if next byte is \n' if we're not connected to a terminal device
-            if (!tty) {
+            if (!isatty(fd)) {
 	       int len = 0;
                ch = readUnicode(&len);
                if (ch >= 0) {
@@ -466,7 +747,7 @@ struct qore_qf_private {
                   }
                   else {
                      // reset file to previous byte position
-                     lseek(fd, -len, SEEK_CUR);
+                     unread(len);
                   }
                }
             }
@@ -650,7 +931,21 @@ struct qore_qf_private {
       if (!is_open)
          return -1;
 
-      return lseek(fd, 0, SEEK_CUR);
+      qore_offset_t pos = lseek(fd, 0, SEEK_CUR);
+      // return the logical position taking into account any data still in the read buffer
+      if (pos > 0)
+         pos -= rbuf_len - rbuf_pos;
+      return pos;
+   }
+
+   DLLLOCAL qore_size_t setPos(qore_size_t pos) {
+      AutoLocker al(m);
+
+      if (!is_open)
+         return -1;
+
+      rbuf_pos = rbuf_len = 0;
+      return lseek(fd, pos, SEEK_SET);
    }
 
    DLLLOCAL void setEventQueue(Queue* cbq, ExceptionSink* xsink) {
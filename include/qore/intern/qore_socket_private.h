@@ -46,14 +46,40 @@
 #include <openssl/ssl.h>
 #include <openssl/err.h>
 
+#ifdef HAVE_POLL_H
+#include <poll.h>
+#endif
+
 #ifdef HAVE_SYS_SELECT_H
 #include <sys/select.h>
 #endif
 
+#ifdef HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif
+
+#include <vector>
+
 #ifndef DEFAULT_SOCKET_BUFSIZE
 #define DEFAULT_SOCKET_BUFSIZE 4096
 #endif
 
+// the maximum size the read buffer is grown to automatically
+#ifndef QORE_MAX_SOCKET_BUFSIZE
+#define QORE_MAX_SOCKET_BUFSIZE (256 * 1024)
+#endif
+
+// the number of consecutive reads filling the read buffer after which the buffer is grown
+#define QORE_SOCKET_BUF_GROW_READS 2
+
+// the size of the buffer used to send file data when sendfile() cannot be used (ex: SSL connections)
+#ifndef QORE_SOCKET_SENDFILE_BUFSIZE
+#define QORE_SOCKET_SENDFILE_BUFSIZE 65536
+#endif
+
+// the maximum number of bytes sent with a single sendfile() call
+#define QORE_SOCKET_SENDFILE_MAX 0x40000000
+
 #ifndef QORE_MAX_HEADER_SIZE
 #define QORE_MAX_HEADER_SIZE 16384
 #endif
@@ -173,6 +199,8 @@ public:
 };
 
 struct qore_socket_private;
+struct qore_qf_private;
+class AbstractCompressionSink;
 
 struct qore_socket_op_helper {
 protected:
@@ -203,10 +231,14 @@ struct qore_socket_private {
    SSLSocketHelper* ssl;
    Queue* cb_queue,
       * warn_queue;
-   // socket buffer for buffered reads
-   char rbuf[DEFAULT_SOCKET_BUFSIZE];
+   // socket buffer for buffered reads; allocated with the first buffered read
+   char* rbuf;
+   // the size of the read buffer
+   size_t rbufsize;
    // current buffer size
    size_t buflen, bufoffset;
+   // number of consecutive reads that filled the read buffer
+   unsigned rbuf_full_reads;
    int64 tl_warning_us;     // timeout threshold for network action warning in microseconds
    double tp_warning_bs;    // throughput warning threshold in B/s
    int64 tp_bytes_sent,     // throughput: bytes sent
@@ -216,18 +248,21 @@ struct qore_socket_private {
       tp_us_min             // throughput: minimum time for transfer to be considered
       ;
    AbstractQoreNode* callback_arg;
-   bool del, in_op, http_exp_chunked_body;
+   bool del, in_op, http_exp_chunked_body,
+      rbuf_fixed;           // true if the read buffer size was set explicitly; the buffer is then not grown automatically
 
    DLLLOCAL qore_socket_private(int n_sock = QORE_INVALID_SOCKET, int n_sfamily = AF_UNSPEC, int n_stype = SOCK_STREAM, int n_prot = 0, const QoreEncoding* n_enc = QCS_DEFAULT) :
       sock(n_sock), sfamily(n_sfamily), port(-1), stype(n_stype), sprot(n_prot), enc(n_enc),
-      ssl(0), cb_queue(0), warn_queue(0), buflen(0), bufoffset(0), tl_warning_us(0), tp_warning_bs(0),
+      ssl(0), cb_queue(0), warn_queue(0), rbuf(0), rbufsize(DEFAULT_SOCKET_BUFSIZE), buflen(0), bufoffset(0),
+      rbuf_full_reads(0), tl_warning_us(0), tp_warning_bs(0),
       tp_bytes_sent(0), tp_bytes_recv(0), tp_us_sent(0), tp_us_recv(0), tp_us_min(0),
-      callback_arg(0), del(false), in_op(false), http_exp_chunked_body(false) {
+      callback_arg(0), del(false), in_op(false), http_exp_chunked_body(false), rbuf_fixed(false) {
       //sendTimeout = recvTimeout = -1
    }
 
    DLLLOCAL ~qore_socket_private() {
       close_internal();
+      free(rbuf);
 
       // must be dereferenced and removed before deleting
       assert(!cb_queue);
@@ -783,6 +818,7 @@ struct qore_socket_private {
 #endif // windows
    }
 
+   // waits for the socket to be readable or writable; a negative timeout waits indefinitely
    // socket must be open!
    DLLLOCAL int select(int timeout_ms, bool read, const char* mname, ExceptionSink* xsink) {
       if (sock == QORE_INVALID_SOCKET) {
@@ -791,26 +827,49 @@ struct qore_socket_private {
 	 return -1;
       }
 
+      int rc;
+#ifdef HAVE_POLL_H
+      // poll() has no limit on the descriptor value, unlike select() with FD_SETSIZE
+      struct pollfd pfd;
+      pfd.fd = sock;
+      pfd.events = read ? POLLIN : POLLOUT;
+      pfd.revents = 0;
+
+      while (true) {
+	 rc = ::poll(&pfd, 1, timeout_ms);
+	 if (rc != QORE_SOCKET_ERROR || sock_get_error() != EINTR)
+	    break;
+      }
+      // poll() reports an invalid descriptor in the event mask instead of failing
+      if (rc > 0 && (pfd.revents & POLLNVAL)) {
+         rc = QORE_SOCKET_ERROR;
+         errno = EBADF;
+      }
+#else
       fd_set sfs;
 
       FD_ZERO(&sfs);
       FD_SET(sock, &sfs);
 
       struct timeval tv;
-      int rc;
       while (true) {
-	 tv.tv_sec  = timeout_ms / 1000;
-	 tv.tv_usec = (timeout_ms % 1000) * 1000;
+	 struct timeval* tvp = 0;
+	 if (timeout_ms >= 0) {
+	    tv.tv_sec  = timeout_ms / 1000;
+	    tv.tv_usec = (timeout_ms % 1000) * 1000;
+	    tvp = &tv;
+	 }
 
-	 rc = read ? ::select(sock + 1, &sfs, 0, 0, &tv) : ::select(sock + 1, 0, &sfs, 0, &tv);
+	 rc = read ? ::select(sock + 1, &sfs, 0, 0, tvp) : ::select(sock + 1, 0, &sfs, 0, tvp);
 	 if (rc != QORE_SOCKET_ERROR || sock_get_error() != EINTR)
 	    break;
       }
+#endif
       if (rc == QORE_SOCKET_ERROR) {
          rc = 0;
          switch (sock_get_error()) {
 #ifdef EBADF
-            // mark the socket as closed if the select call fails due to a bad file descriptor error
+            // mark the socket as closed if the wait fails due to a bad file descriptor error
             case EBADF:
                close();
                if (xsink)
@@ -818,7 +877,7 @@ struct qore_socket_private {
                break;
 #endif
             default:
-               qore_socket_error(xsink, "SOCKET-SELECT-ERROR", "select() returned an error");
+               qore_socket_error(xsink, "SOCKET-SELECT-ERROR", "error waiting for socket I/O");
                break;
          }
       }
@@ -826,6 +885,11 @@ struct qore_socket_private {
       return rc;
    }
 
+   // waits for data to be available on any of the given open socket descriptors; a negative timeout waits indefinitely
+   // entries in ready that are already set (for sockets with buffered data) are not waited on and cause an immediate return
+   // returns the number of ready sockets, 0 on timeout, or -1 if an exception was raised
+   DLLLOCAL static int waitForData(const std::vector<int>& socks, std::vector<bool>& ready, int timeout_ms, const char* mname, ExceptionSink* xsink);
+
    DLLLOCAL bool isSocketDataAvailable(int timeout_ms, const char* mname, ExceptionSink* xsink) {
       return select(timeout_ms, true, mname, xsink);
    }
@@ -836,6 +900,11 @@ struct qore_socket_private {
       return isSocketDataAvailable(timeout_ms, mname, xsink);
    }
 
+   // returns true if data has already been read from the socket and can be returned without waiting on the socket
+   DLLLOCAL bool isDataBuffered() const {
+      return buflen || (ssl && ssl->pending());
+   }
+
    DLLLOCAL bool isWriteFinished(int timeout_ms, const char* mname, ExceptionSink* xsink) {
       return select(timeout_ms, false, mname, xsink);
    }
@@ -1336,31 +1405,9 @@ struct qore_socket_private {
 #endif
    }
 
-   // buffered reads for high performance
-   DLLLOCAL qore_offset_t brecv(ExceptionSink* xsink, const char* meth, char*& buf, qore_size_t bs, int flags, int timeout, bool do_event = true) {
-      // must be checked if open/connected before this function is called
-      assert(sock != QORE_INVALID_SOCKET);
-      assert(meth);
-
-      // always returned buffered data first
-      if (buflen) {
-	 buf = rbuf + bufoffset;
-	 if (buflen <= bs) {
-	    bs = buflen;
-	    buflen = 0;
-	    bufoffset = 0;
-	 }
-	 else {
-	    buflen -= bs;
-	    bufoffset += bs;
-	 }
-	 return (qore_offset_t)bs;
-      }
-
-      // real socket reads are only done when the buffer is empty
-
-      //printd(5, "qore_socket_private::brecv(buf=%p, bs=%d, flags=%d, timeout=%d, do_event=%d) this=%p ssl=%d\n", buf, (int)bs, flags, timeout, (int)do_event, this, ssl);
-
+   // reads from the socket or SSL connection into the given buffer, waiting up to timeout ms for data to be available
+   // the socket is closed if the remote end has closed the connection
+   DLLLOCAL qore_offset_t readIntern(ExceptionSink* xsink, const char* meth, char* dest, qore_size_t bs, int flags, int timeout) {
       qore_offset_t rc;
       if (!ssl) {
 	 if (timeout != -1 && !isDataAvailable(timeout, meth, xsink)) {
@@ -1377,7 +1424,7 @@ struct qore_socket_private {
 #ifdef DEBUG
 	    errno = 0;
 #endif
-	    rc = ::recv(sock, rbuf, DEFAULT_SOCKET_BUFSIZE, flags);
+	    rc = ::recv(sock, dest, bs, flags);
 	    if (rc == QORE_SOCKET_ERROR) {
 	       sock_get_error();
 	       if (errno == EINTR)
@@ -1394,17 +1441,93 @@ struct qore_socket_private {
 		  qore_socket_error(xsink, "SOCKET-RECV-ERROR", "error in recv()", meth);
 	       break;
 	    }
-	    //printd(5, "qore_socket_private::brecv(%d, %p, %ld, %d) rc=%ld errno=%d\n", sock, buf, bs, flags, rc, errno);
+	    //printd(5, "qore_socket_private::readIntern(%d, %p, %ld, %d) rc=%ld errno=%d\n", sock, dest, bs, flags, rc, errno);
 	    // try again if we were interrupted by a signal
 	    if (rc >= 0)
 	       break;
 	 }
       }
       else
-	 rc = ssl->read(meth, rbuf, DEFAULT_SOCKET_BUFSIZE, timeout, xsink);
+	 rc = ssl->read(meth, dest, bs, timeout, xsink);
+
+      if (!rc)
+	 close();
+
+      return rc;
+   }
+
+   // buffered reads for high performance
+   DLLLOCAL qore_offset_t brecv(ExceptionSink* xsink, const char* meth, char*& buf, qore_size_t bs, int flags, int timeout, bool do_event = true) {
+      // must be checked if open/connected before this function is called
+      assert(sock != QORE_INVALID_SOCKET);
+      assert(meth);
+
+      // always returned buffered data first
+      if (buflen) {
+	 buf = rbuf + bufoffset;
+	 if (buflen <= bs) {
+	    bs = buflen;
+	    buflen = 0;
+	    bufoffset = 0;
+	 }
+	 else {
+	    buflen -= bs;
+	    bufoffset += bs;
+	 }
+	 return (qore_offset_t)bs;
+      }
+
+      // real socket reads are only done when the buffer is empty
+
+      //printd(5, "qore_socket_private::brecv(buf=%p, bs=%d, flags=%d, timeout=%d, do_event=%d) this=%p ssl=%d\n", buf, (int)bs, flags, timeout, (int)do_event, this, ssl);
+
+      if (!rbuf) {
+	 rbuf = (char*)malloc(rbufsize);
+	 if (!rbuf) {
+	    if (xsink)
+	       xsink->outOfMemory();
+	    return QSE_RECV_ERR;
+	 }
+      }
+      else if (rbuf_full_reads >= QORE_SOCKET_BUF_GROW_READS) {
+	 // the buffer is empty, so it can be grown without copying
+	 size_t size = rbufsize * 2;
+	 if (size > QORE_MAX_SOCKET_BUFSIZE)
+	    size = QORE_MAX_SOCKET_BUFSIZE;
+	 // if the larger buffer cannot be allocated, the current buffer is kept
+	 char* nbuf = (char*)malloc(size);
+	 if (nbuf) {
+	    free(rbuf);
+	    rbuf = nbuf;
+	    rbufsize = size;
+	 }
+	 rbuf_full_reads = 0;
+      }
+
+      qore_offset_t rc = readIntern(xsink, meth, rbuf, rbufsize, flags, timeout);
 
       //printd(5, "qore_socket_private::brecv(%d, %p, %ld, %d) rc: %ld errno: %d\n", sock, buf, bs, flags, rc, errno);
       if (rc > 0) {
+	 // grow the buffer under sustained throughput, when reads keep filling the buffer
+	 if ((size_t)rc == rbufsize) {
+	    if (!rbuf_fixed && rbufsize < QORE_MAX_SOCKET_BUFSIZE)
+	       ++rbuf_full_reads;
+	 }
+	 else {
+	    rbuf_full_reads = 0;
+	    // a grown buffer is returned to the default size when the data read would fit into it, so only sockets
+	    // that are receiving data at a high rate keep a large buffer; the data read is moved to the new buffer
+	    if (!rbuf_fixed && rbufsize > DEFAULT_SOCKET_BUFSIZE && (size_t)rc <= DEFAULT_SOCKET_BUFSIZE) {
+	       char* nbuf = (char*)malloc(DEFAULT_SOCKET_BUFSIZE);
+	       if (nbuf) {
+		  memcpy(nbuf, rbuf, rc);
+		  free(rbuf);
+		  rbuf = nbuf;
+		  rbufsize = DEFAULT_SOCKET_BUFSIZE;
+	       }
+	    }
+	 }
+
 	 buf = rbuf;
 	 assert(!buflen);
 	 assert(!bufoffset);
@@ -1418,17 +1541,64 @@ struct qore_socket_private {
 	 if (do_event)
 	    do_read_event(rc, rc);
       }
-      else {
 #ifdef DEBUG
+      else
 	 buf = 0;
 #endif
-	 if (!rc)
-	    close();
-      }
 
       return rc;
    }
 
+   // returns the last n bytes of the rc bytes returned by the last call to brecv() in buf to the read buffer
+   DLLLOCAL void unread(const char* buf, qore_size_t rc, qore_size_t n) {
+      assert(buf >= rbuf && buf + rc <= rbuf + rbufsize);
+      assert(n <= rc);
+      if (!n)
+	 return;
+      // any data still buffered immediately follows the data returned
+      assert(!buflen || rbuf + bufoffset == buf + rc);
+      bufoffset = (buf - rbuf) + rc - n;
+      buflen += n;
+   }
+
+   // sets the size of the read buffer; a size of 0 restores the default size with automatic growth
+   DLLLOCAL int setReadBufferSize(qore_size_t size, ExceptionSink* xsink) {
+      if (size > QORE_MAX_SOCKET_BUFSIZE) {
+	 xsink->raiseException("SOCKET-SETREADBUFFERSIZE-ERROR", "the read buffer size cannot exceed %d bytes (value passed: "QLLD")", QORE_MAX_SOCKET_BUFSIZE, (int64)size);
+	 return -1;
+      }
+
+      if (!size) {
+	 size = DEFAULT_SOCKET_BUFSIZE;
+	 rbuf_fixed = false;
+      }
+      else
+	 rbuf_fixed = true;
+      rbuf_full_reads = 0;
+
+      // data already buffered is kept
+      if (size < buflen)
+	 size = buflen;
+      if (rbuf) {
+	 if (buflen && bufoffset)
+	    memmove(rbuf, rbuf + bufoffset, buflen);
+	 bufoffset = 0;
+	 char* nbuf = (char*)realloc(rbuf, size);
+	 if (!nbuf) {
+	    // the current buffer and its data are kept
+	    xsink->outOfMemory();
+	    return -1;
+	 }
+	 rbuf = nbuf;
+      }
+      rbufsize = size;
+      return 0;
+   }
+
+   DLLLOCAL qore_size_t getReadBufferSize() const {
+      return rbufsize;
+   }
+
    //! read until \\r\\n\\r\\n and return the string
    DLLLOCAL QoreStringNode* readHTTPData(ExceptionSink* xsink, const char* meth, int timeout, qore_offset_t& rc, bool exit_early = false) {
       assert(meth);
@@ -1454,8 +1624,9 @@ struct qore_socket_private {
 
       while (true) {
 	 char* buf;
-	 rc = brecv(xsink, meth, buf, 1, 0, timeout, false);
-	 //printd(5, "qore_socket_private::readHTTPData() this: %p Socket::%s(): rc: "QLLD" read char: %c (%03d) (old state: %d)\n", this, meth, rc, rc > 0 && buf[0] > 31 ? buf[0] : '?', rc > 0 ? buf[0] : 0, state);
+	 // read all buffered data at once; any data following the header is returned to the buffer
+	 rc = brecv(xsink, meth, buf, rbufsize, 0, timeout, false);
+	 //printd(5, "qore_socket_private::readHTTPData() this: %p Socket::%s(): rc: "QLLD" (state: %d)\n", this, meth, rc, state);
 	 if (rc <= 0) {
 	    //printd(5, "qore_socket_private::readHTTPData(timeout=%d) hdr='%s' (len: %d), rc="QSD", errno=%d: '%s'\n", timeout, hdr->getBuffer(), hdr->strlen(), rc, errno, strerror(errno));
 
@@ -1469,51 +1640,66 @@ struct qore_socket_private {
 	    }
 	    return 0;
 	 }
-	 char c = buf[0];
-	 if (++count == QORE_MAX_HEADER_SIZE) {
-	    if (xsink)
-	       xsink->raiseException("SOCKET-HTTP-ERROR", "header size cannot exceed "QSD" bytes", count);
-	    return 0;
-	 }
 
-	 // check if we can progress to the next state
-	 if (c == '\n') {
-	    if (state == -1) {
-	       state = 3;
-	       continue;
+	 bool done = false;
+	 qore_offset_t i = 0;
+	 for (; i < rc; ++i) {
+	    char c = buf[i];
+	    if (++count == QORE_MAX_HEADER_SIZE) {
+	       if (xsink)
+		  xsink->raiseException("SOCKET-HTTP-ERROR", "header size cannot exceed "QSD" bytes", count);
+	       return 0;
 	    }
-	    if (!state) {
-               if (exit_early && hdr->empty())
-                  return 0;
-	       state = 1;
-	       continue;
+
+	    // check if we can progress to the next state
+	    if (c == '\n') {
+	       if (state == -1) {
+		  state = 3;
+		  continue;
+	       }
+	       if (!state) {
+		  if (exit_early && hdr->empty()) {
+		     unread(buf, rc, rc - i - 1);
+		     return 0;
+		  }
+		  state = 1;
+		  continue;
+	       }
+	       assert(state > 0);
+	       done = true;
+	       break;
 	    }
-	    assert(state > 0);
-	    break;
-	 }
-	 else if (c == '\r') {
-	    if (state == -1) {
-	       state = 0;
-	       continue;
+	    else if (c == '\r') {
+	       if (state == -1) {
+		  state = 0;
+		  continue;
+	       }
+	       if (!state) {
+		  done = true;
+		  break;
+	       }
+	       if (state == 1) {
+		  state = 2;
+		  continue;
+	       }
 	    }
-	    if (!state)
-	       break;
-	    if (state == 1) {
-	       state = 2;
-	       continue;
+
+	    if (state != -1) {
+	       switch (state) {
+		  case 0: hdr->concat('\r'); break;
+		  case 1: hdr->concat("\r\n"); break;
+		  case 2: hdr->concat("\r\n\r"); break;
+		  case 3: hdr->concat('\n'); break;
+	       }
+	       state = -1;
 	    }
+	    hdr->concat(c);
 	 }
 
-	 if (state != -1) {
-	    switch (state) {
-	       case 0: hdr->concat('\r'); break;
-	       case 1: hdr->concat("\r\n"); break;
-	       case 2: hdr->concat("\r\n\r"); break;
-	       case 3: hdr->concat('\n'); break;
-	    }
-	    state = -1;
+	 if (done) {
+	    unread(buf, rc, rc - i - 1);
+	    break;
 	 }
-	 hdr->concat(c);
       }
       hdr->concat('\n');
 
@@ -1540,31 +1726,36 @@ struct qore_socket_private {
 
       PrivateQoreSocketThroughputHelper th(this, false);
 
-      qore_size_t bs = bufsize > 0 && bufsize < DEFAULT_SOCKET_BUFSIZE ? bufsize : DEFAULT_SOCKET_BUFSIZE;
-
       QoreStringNodeHolder str(new QoreStringNode(enc));
 
       char* buf;
 
       while (true) {
-	 rc = brecv(xsink, "recv", buf, bs, 0, timeout, false);
+	 qore_size_t bs = bufsize > 0 ? bufsize - str->size() : rbufsize;
+
+	 // once buffered data has been returned, large reads are made directly into the string
+	 if (!buflen && bufsize > 0 && bs >= rbufsize) {
+	    qore_size_t size = str->size();
+	    str->reserve(bufsize);
+	    rc = readIntern(xsink, "recv", const_cast<char*>(str->getBuffer()) + size, bs, 0, timeout);
+	    str->terminate(rc > 0 ? size + rc : size);
+	 }
+	 else {
+	    rc = brecv(xsink, "recv", buf, bs, 0, timeout, false);
+	    if (rc > 0)
+	       str->concat(buf, rc);
+	 }
 
 	 if (rc <= 0) {
 	    printd(5, "qore_socket_private::recv(%d, %d) bs="QSD", br="QSD", rc="QSD", errno=%d (%s)\n", bufsize, timeout, bs, str->size(), rc, errno, strerror(errno));
 	    break;
 	 }
 
-	 str->concat(buf, rc);
-
 	 // register event
 	 do_read_event(rc, str->size(), bufsize);
 
-	 if (bufsize > 0) {
-	    if (str->size() >= (qore_size_t)bufsize)
-	       break;
-	    if ((bufsize - str->size()) < bs)
-	       bs = bufsize - str->size();
-	 }
+	 if (bufsize > 0 && str->size() >= (qore_size_t)bufsize)
+	    break;
       }
 
       printd(5, "qore_socket_private::recv() received "QSD" byte(s), bufsize="QSD", strlen="QSD" str='%s'\n", str->size(), bufsize, (size_t)(str ? str->strlen() : 0), str ? str->getBuffer() : "n/a");
@@ -1598,7 +1789,7 @@ struct qore_socket_private {
 
       // perform first read with timeout
       char* buf;
-      rc = brecv(xsink, "recv", buf, DEFAULT_SOCKET_BUFSIZE, 0, timeout, false);
+      rc = brecv(xsink, "recv", buf, rbufsize, 0, timeout, false);
       if (rc <= 0)
 	 return 0;
 
@@ -1610,7 +1801,7 @@ struct qore_socket_private {
       // keep reading data until no more data is available without a timeout
       if (isDataAvailable(0, "recv", xsink)) {
 	 do {
-	    rc = brecv(xsink, "recv", buf, DEFAULT_SOCKET_BUFSIZE, 0, 0, false);
+	    rc = brecv(xsink, "recv", buf, rbufsize, 0, 0, false);
 	    //printd(5, "qore_socket_private::recv(to=%d) rc="QSD" rd="QSD"\n", timeout, rc, str->size());
 	    // if the remote end has closed the connection, return what we have
 	    if (!rc)
@@ -1651,24 +1842,34 @@ struct qore_socket_private {
 
       PrivateQoreSocketThroughputHelper th(this, false);
 
-      qore_size_t bs = bufsize > 0 && bufsize < DEFAULT_SOCKET_BUFSIZE ? bufsize : DEFAULT_SOCKET_BUFSIZE;
-
       SimpleRefHolder<BinaryNode> b(new BinaryNode);
 
       char* buf;
       while (true) {
-	 rc = brecv(xsink, "recvBinary", buf, bs, 0, timeout);
-	 if (rc <= 0)
-	    break;
-
-	 b->append(buf, rc);
+	 qore_size_t bs = bufsize > 0 ? bufsize - b->size() : rbufsize;
+
+	 // once buffered data has been returned, large reads are made directly into the binary object
+	 if (!buflen && bufsize > 0 && bs >= rbufsize) {
+	    qore_size_t size = b->size();
+	    b->preallocate(bufsize);
+	    rc = readIntern(xsink, "recvBinary", (char*)b->getPtr() + size, bs, 0, timeout);
+	    b->setSize(rc > 0 ? size + rc : size);
+	    if (rc <= 0)
+	       break;
 
-	 if (bufsize > 0) {
-	    if (b->size() >= (qore_size_t)bufsize)
+	    // register event
+	    do_read_event(rc, rc);
+	 }
+	 else {
+	    rc = brecv(xsink, "recvBinary", buf, bs, 0, timeout);
+	    if (rc <= 0)
 	       break;
-	    if ((bufsize - b->size()) < bs)
-	       bs = bufsize - b->size();
+
+	    b->append(buf, rc);
 	 }
+
+	 if (bufsize > 0 && b->size() >= (qore_size_t)bufsize)
+	    break;
       }
 
       th.finalize(b->size());
@@ -1705,7 +1906,7 @@ struct qore_socket_private {
       //printd(5, "QoreSocket::recvBinary(%d, "QSD") this=%p\n", timeout, rc, this);
       // perform first read with timeout
       char* buf;
-      rc = brecv(xsink, "recvBinary", buf, DEFAULT_SOCKET_BUFSIZE, 0, timeout, false);
+      rc = brecv(xsink, "recvBinary", buf, rbufsize, 0, timeout, false);
       if (rc <= 0)
 	 return 0;
 
@@ -1717,7 +1918,7 @@ struct qore_socket_private {
       // keep reading data until no more data is available without a timeout
       if (isDataAvailable(0, "recvBinary", xsink)) {
 	 do {
-	    rc = brecv(xsink, "recvBinary", buf, DEFAULT_SOCKET_BUFSIZE, 0, 0, false);
+	    rc = brecv(xsink, "recvBinary", buf, rbufsize, 0, 0, false);
 	    // if the remote end has closed the connection, return what we have
 	    if (!rc)
 	       break;
@@ -2126,6 +2327,167 @@ struct qore_socket_private {
       return rc < 0 || sock == QORE_INVALID_SOCKET ? rc : 0;
    }
 
+#ifdef HAVE_SYS_SENDFILE_H
+   // sends file data directly from the file descriptor with sendfile(); only for non-SSL connections
+   // returns 0 for OK, 1 if sendfile() is not supported for the file descriptor and no data was sent, < 0 for error
+   DLLLOCAL int sendfileIntern(ExceptionSink* xsink, const char* mname, int fd, int64 size, int timeout_ms, int64& bs) {
+      assert(!ssl);
+
+      // set the non-blocking flag (for use with non-ssl connections)
+      bool nb = (timeout_ms >= 0);
+
+      while (size < 0 || bs < size) {
+         size_t bn = (size < 0 || (size - bs) > QORE_SOCKET_SENDFILE_MAX) ? QORE_SOCKET_SENDFILE_MAX : (size_t)(size - bs);
+         ssize_t rc = ::sendfile(sock, fd, 0, bn);
+         //printd(5, "qore_socket_private::sendfileIntern() this: %p Socket::%s() fd: %d size: "QLLD" bs: "QLLD" rc: "QSD"\n", this, mname, fd, size, bs, rc);
+         // end of file
+         if (!rc)
+            break;
+         if (rc < 0) {
+            if (errno == EINTR)
+               continue;
+            // check that the send finishes before the timeout if we are using non-blocking I/O
+            if (nb && (errno == EAGAIN
+#ifdef EWOULDBLOCK
+                       || errno == EWOULDBLOCK
+#endif
+                   )) {
+               if (!isWriteFinished(timeout_ms, mname, xsink)) {
+                  if (xsink) {
+                     if (*xsink)
+                        return -1;
+                     se_timeout(mname, timeout_ms, xsink);
+                  }
+                  return QSE_TIMEOUT;
+               }
+               continue;
+            }
+            // the file descriptor cannot be used with sendfile(); the caller will fall back to read() and send()
+            if (!bs && (errno == EINVAL || errno == ENOSYS))
+               return 1;
+
+            if (xsink)
+               xsink->raiseErrnoException("SOCKET-SEND-ERROR", errno, "error while executing Socket::%s()", mname);
+#ifdef EPIPE
+            if (errno == EPIPE)
+               close();
+#endif
+#ifdef ECONNRESET
+            if (errno == ECONNRESET)
+               close();
+#endif
+            return -1;
+         }
+
+         bs += rc;
+         do_send_event(rc, bs, size < 0 ? bs : size);
+      }
+
+      return 0;
+   }
+#endif
+
+   // sends "size" bytes (or all data up to the end of the file if size is negative) from the current position of the given file descriptor
+   // uses sendfile() for non-SSL connections where possible, otherwise reads and sends the data in blocks
+   // returns 0 for OK, < 0 for error
+   DLLLOCAL int sendFileIntern(ExceptionSink* xsink, const char* mname, int fd, int64 size, int timeout_ms, int64& total) {
+      int64 bs = 0;
+      int rc;
+
+#ifdef HAVE_SYS_SENDFILE_H
+      if (!ssl) {
+         rc = sendfileIntern(xsink, mname, fd, size, timeout_ms, bs);
+         total += bs;
+         if (rc < 0)
+            return rc;
+      }
+      else
+         rc = 1;
+
+      if (rc)
+#endif
+      {
+         char* buf = (char*)malloc(sizeof(char) * QORE_SOCKET_SENDFILE_BUFSIZE);
+         rc = 0;
+
+         while (size < 0 || bs < size) {
+            qore_size_t bn = (size < 0 || (size - bs) > QORE_SOCKET_SENDFILE_BUFSIZE) ? QORE_SOCKET_SENDFILE_BUFSIZE : (qore_size_t)(size - bs);
+            qore_offset_t rrc = ::read(fd, buf, bn);
+            // end of file
+            if (!rrc)
+               break;
+            if (rrc < 0) {
+               if (errno == EINTR)
+                  continue;
+               if (xsink)
+                  xsink->raiseErrnoException("SOCKET-SENDFILE-ERROR", errno, "error reading file data in Socket::%s()", mname);
+               rc = -1;
+               break;
+            }
+
+            if ((rc = sendIntern(xsink, mname, buf, rrc, timeout_ms, total)) < 0 || sock == QORE_INVALID_SOCKET) {
+               if (rc >= 0)
+                  rc = -1;
+               break;
+            }
+            rc = 0;
+            bs += rrc;
+         }
+
+         free(buf);
+         if (rc)
+            return rc;
+      }
+
+      // the file must provide all the data requested, otherwise the peer will be waiting for data that will never be sent
+      if (size > 0 && bs < size) {
+         if (xsink)
+            xsink->raiseException("SOCKET-SENDFILE-ERROR", "Socket::%s(): end of file reached after sending "QLLD" byte%s of "QLLD" bytes requested", mname, bs, bs == 1 ? "" : "s", size);
+         return -1;
+      }
+
+      return 0;
+   }
+
+   // returns the number of bytes sent or < 0 for error
+   DLLLOCAL int64 sendFile(ExceptionSink* xsink, const char* mname, int fd, int64 size, int timeout_ms = -1) {
+      if (sock == QORE_INVALID_SOCKET) {
+	 if (xsink)
+	    se_not_open(mname, xsink);
+
+	 return QSE_NOT_OPEN;
+      }
+      if (in_op) {
+         if (xsink)
+            se_in_op(mname, xsink);
+         return QSE_IN_OP;
+      }
+
+      PrivateQoreSocketThroughputHelper th(this, true);
+
+      // set the non-blocking flag (for use with non-ssl connections)
+      bool nb = (timeout_ms >= 0);
+      // set non-blocking I/O (and restore on exit) if we have a timeout and a non-ssl connection
+      OptionalNonBlockingHelper onbh(*this, !ssl && nb, xsink);
+      if (xsink && *xsink)
+         return -1;
+
+      int64 total = 0;
+      int rc = sendFileIntern(xsink, mname, fd, size, timeout_ms, total);
+      th.finalize(total);
+
+      if (rc < 0)
+         return rc;
+      return sock == QORE_INVALID_SOCKET ? -1 : total;
+   }
+
+   // sends data from the logical read position of an open file, including any data in the file's read buffer; the file's lock must be held
+   // defined in QoreSocket.cpp; returns the number of bytes sent or < 0 for error
+   DLLLOCAL int64 sendFileData(ExceptionSink* xsink, const char* mname, qore_qf_private& f, int64 size, int timeout_ms);
+
+   // locks the file and sends data from its current position; defined in QoreSocket.cpp
+   DLLLOCAL int64 sendFile(ExceptionSink* xsink, const char* mname, QoreFile& file, int64 size, int timeout_ms = -1);
+
    DLLLOCAL int sendHttpMessage(ExceptionSink* xsink, QoreHashNode* info, const char* method, const char* path, const char* http_version, const QoreHashNode* headers, const void *data, qore_size_t size, const ResolvedCallReferenceNode* send_callback, int source, int timeout_ms = -1, QoreThreadLock* l = 0, bool* aborted = 0) {
       assert(!(data && send_callback));
       // prepare header string
@@ -2190,6 +2552,16 @@ struct qore_socket_private {
       return 0;
    }
 
+   // sends an HTTP response with a message body taken from the current position of the given file; defined in QoreSocket.cpp
+   DLLLOCAL int sendHttpResponseFile(ExceptionSink* xsink, int code, const char* desc, const char* http_version, const QoreHashNode* headers, QoreFile& file, int64 size, int source, int timeout_ms = -1);
+
+   // reads an HTTP message body and passes the data to the sink directly from the read buffer as it is received; defined in QoreSocket.cpp
+   /* if chunked is true, the body is read in HTTP chunked format and a hash of any footers is returned; otherwise len
+      bytes are read, or all data until the remote end closes the connection if len < 0, and 0 is returned; the caller
+      must check xsink for errors
+   */
+   DLLLOCAL QoreHashNode* readHttpBody(AbstractCompressionSink& sink, bool chunked, qore_offset_t len, int timeout, ExceptionSink* xsink, int source);
+
    DLLLOCAL QoreHashNode* readHttpChunkedBodyBinary(int timeout, ExceptionSink* xsink, int source, const ResolvedCallReferenceNode* recv_callback = 0, QoreThreadLock* l = 0, QoreObject* obj = 0) {
       assert(xsink);
 
@@ -2263,7 +2635,7 @@ struct qore_socket_private {
          // prepare string for chunk
          //str.allocate(size + 1);
 
-         qore_offset_t bs = size < DEFAULT_SOCKET_BUFSIZE ? size : DEFAULT_SOCKET_BUFSIZE;
+         qore_offset_t bs = size < (qore_offset_t)rbufsize ? size : (qore_offset_t)rbufsize;
          qore_offset_t br = 0; // bytes received
          while (true) {
             char* buf;
@@ -2418,7 +2790,7 @@ struct qore_socket_private {
          //buf->allocate((unsigned)(buf->strlen() + size + 1));
 
          // read chunk directly into string buffer
-         qore_offset_t bs = size < DEFAULT_SOCKET_BUFSIZE ? size : DEFAULT_SOCKET_BUFSIZE;
+         qore_offset_t bs = size < (qore_offset_t)rbufsize ? size : (qore_offset_t)rbufsize;
          qore_offset_t br = 0; // bytes received
          str.clear();
          while (true) {
@@ -2743,7 +3115,7 @@ struct qore_socket_private {
 	    return (int)rc;
 	 }
 
-	 memcpy(targ, buf, rc);
+	 memcpy((char*)targ + br, buf, rc);
 
 	 br += rc;
 	 if (br >= len)
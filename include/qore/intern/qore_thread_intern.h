@@ -475,11 +475,18 @@ public:
 DLLLOCAL const QoreListNode* thread_get_implicit_args();
 
 DLLLOCAL LocalVarValue* thread_find_lvar(const char* id);
+// finds a local variable using and updating the given slot hint
+DLLLOCAL LocalVarValue* thread_find_lvar(const char* id, int& hint);
 
 // to get the current runtime object
 DLLLOCAL QoreObject* runtime_get_stack_object();
 // to get the current runtime class
 DLLLOCAL const qore_class_private* runtime_get_class();
+
+// call-site variant cache statistics for the current thread
+DLLLOCAL void thread_variant_cache_hit();
+DLLLOCAL void thread_variant_cache_miss();
+DLLLOCAL void thread_get_variant_cache_stats(int64& hits, int64& misses);
 // for methods that behave differently when called within the method itself (methodGate(), memberGate(), etc)
 DLLLOCAL bool runtime_in_object_method(const char* name, const QoreObject* o);
 
@@ -34,6 +34,8 @@
 #ifndef _QORE_VAR_RWLOCK_PRIV_H
 #define _QORE_VAR_RWLOCK_PRIV_H
 
+#include <qore/intern/qore_atomic.h>
+
 class qore_var_rwlock_priv {
 protected:
    DLLLOCAL virtual void notifyIntern() {
@@ -44,6 +46,38 @@ protected:
    //! this function is not implemented; it is here as a private function in order to prohibit it from being used
    DLLLOCAL qore_var_rwlock_priv& operator=(const qore_var_rwlock_priv&);
 
+   // stops the thread the lock is biased to from making new unlocked reads; the lock must be held
+   DLLLOCAL void revokeBiasIntern() {
+      qore_atomic_store(&biased, false);
+      // the owner must see the revocation before we check bias_readers
+      qore_atomic_fence();
+   }
+
+   // makes a read without taking the lock if the lock is still biased to the current thread
+   DLLLOCAL bool biasedReadLock() {
+      assert(write_tid != bias_tid);
+      qore_atomic_store(&bias_readers, bias_readers + 1);
+      // the revoking thread must see the unlocked read before we check the bias
+      qore_atomic_fence();
+      if (qore_atomic_load(&biased))
+         return true;
+      // the bias has been revoked; use the lock normally
+      biasedReadUnlock();
+      return false;
+   }
+
+   DLLLOCAL void biasedReadUnlock() {
+      assert(bias_readers > 0);
+      qore_atomic_store(&bias_readers, bias_readers - 1);
+      qore_atomic_fence();
+      // wake up any writer waiting for unlocked reads to finish after the bias was revoked
+      if (!qore_atomic_load(&biased)) {
+         AutoLocker al(l);
+         if (!qore_atomic_load(&bias_readers) && !readers)
+            unlock_read_signal();
+      }
+   }
+
 public:
    QoreThreadLock l;
    int write_tid,
@@ -54,21 +88,44 @@ public:
       read_cond;
    bool has_notify;
 
+   // the thread that can read without locking as long as "biased" is true; -1 if the lock is not biased
+   int bias_tid;
+   // number of unlocked reads in progress in the bias_tid thread; only changed by that thread, always accessed atomically
+   // by other threads
+   int bias_readers;
+   // cleared permanently by the first other thread to grab the write lock; always accessed atomically
+   bool biased;
+
    //! creates and initializes the lock
-   DLLLOCAL qore_var_rwlock_priv() : write_tid(-1), readers(0), read_waiting(0), write_waiting(0), has_notify(false) {
+   DLLLOCAL qore_var_rwlock_priv() : write_tid(-1), readers(0), read_waiting(0), write_waiting(0), has_notify(false), bias_tid(-1), bias_readers(0), biased(false) {
    }
 
    //! destroys the lock
    DLLLOCAL virtual ~qore_var_rwlock_priv() {
    }
 
+   //! biases the lock to the current thread, which can then make reads without locking until another thread grabs the write lock
+   /** the handshake between unlocked reads and revocation needs lock-free barriers, so without atomic builtins the lock
+       is never biased and the normal locking paths are always used
+   */
+   DLLLOCAL void setBias() {
+#ifdef HAVE_QORE_ATOMIC_BUILTINS
+      assert(bias_tid == -1);
+      bias_tid = gettid();
+      biased = true;
+#endif
+   }
+
    //! grabs the write lock
    DLLLOCAL void wrlock() {
       int tid = gettid();
       AutoLocker al(l);
       assert(tid != write_tid);
 
-      while (readers || write_tid != -1) {
+      if (qore_atomic_load(&biased) && tid != bias_tid)
+         revokeBiasIntern();
+
+      while (readers || write_tid != -1 || qore_atomic_load(&bias_readers)) {
 	 ++write_waiting;
 	 write_cond.wait(l);
 	 --write_waiting;
@@ -82,7 +139,9 @@ public:
       int tid = gettid();
       AutoLocker al(l);
       assert(tid != write_tid);
-      if (readers || write_tid != -1)
+      if (qore_atomic_load(&biased) && tid != bias_tid)
+         revokeBiasIntern();
+      if (readers || write_tid != -1 || qore_atomic_load(&bias_readers))
 	 return -1;
 
       write_tid = tid;
@@ -92,6 +151,11 @@ public:
    //! unlocks the lock (assumes the lock is locked)
    DLLLOCAL void unlock() {
       int tid = gettid();
+      // write_tid can only equal the current thread's TID if the current thread holds the write lock
+      if (tid == bias_tid && bias_readers && write_tid != tid) {
+         biasedReadUnlock();
+         return;
+      }
       AutoLocker al(l);
       if (write_tid == tid) {
          write_tid = -1;
@@ -109,6 +173,8 @@ public:
 
    //! grabs the read lock
    DLLLOCAL void rdlock() {
+      if (bias_tid != -1 && qore_atomic_load(&biased) && bias_tid == gettid() && biasedReadLock())
+         return;
       AutoLocker al(l);
       assert(write_tid != gettid());
       while (write_tid != -1) {
@@ -122,6 +188,8 @@ public:
 
    //! tries to grab the read lock; does not block if unsuccessful; returns 0 if successful
    DLLLOCAL int tryrdlock() {
+      if (bias_tid != -1 && qore_atomic_load(&biased) && bias_tid == gettid() && biasedReadLock())
+         return 0;
       AutoLocker al(l);
       assert(write_tid != gettid());
       if (write_tid != -1)
@@ -434,7 +434,8 @@ QoreHashNode *Context::getRow(ExceptionSink *xsink) {
    if (!value)
       return 0;
 
-   ReferenceHolder<QoreHashNode> h(new QoreHashNode(), xsink);
+   // rows share the key table of the column hash
+   ReferenceHolder<QoreHashNode> h(value->copyKeys(), xsink);
 
    HashIterator hi(value);
    while (hi.next()) {
@@ -50,6 +50,181 @@ static void ambiguousDuplicateSignatureException(const char* cname, const char*
    parseException("DUPLICATE-SIGNATURE", "%s%s%s(%s) matches already declared variant %s(%s)", cname ? cname : "", cname ? "::" : "", name, sig2->getSignatureText(), name, sig1->getSignatureText());
 }
 
+unsigned qore_method_gen = 0;
+
+void qore_method_cache_invalidate() {
+   qore_atomic_fetch_add(&qore_method_gen, 1u);
+}
+
+static unsigned qore_cache_serial = 0;
+
+unsigned qore_cache_serial_next() {
+   return qore_atomic_fetch_add(&qore_cache_serial, 1u) + 1;
+}
+
+bool VariantCache::Entry::set(const QoreFunction* f, const QoreValueList* args, unsigned n) {
+   func = f;
+   variant = 0;
+   ctx = 0;
+   nargs = n;
+
+   bool has_obj = false;
+   for (unsigned i = 0; i < n; ++i) {
+      const QoreValue v = args->retrieveEntry(i);
+      types[i] = v.getType();
+      if (types[i] == NT_OBJECT) {
+         classes[i] = qore_class_private::get(*v.get<const QoreObject>()->getClass())->serial;
+         has_obj = true;
+      }
+      else
+         classes[i] = 0;
+   }
+   return has_obj;
+}
+
+void VariantCache::store(unsigned i, const Entry& e) {
+   unsigned s = seq[i];
+   qore_atomic_store(&seq[i], s + 1);
+   qore_atomic_fence_release();
+   entry[i] = e;
+   qore_atomic_store_release(&seq[i], s + 2);
+}
+
+void VariantCache::clear() {
+   Entry empty;
+   empty.func = 0;
+   empty.variant = 0;
+   empty.nargs = 0;
+   for (unsigned i = 0; i < QORE_VARIANT_CACHE_SIZE; ++i)
+      if (seq[i])
+         store(i, empty);
+   next = 0;
+   qore_atomic_store(&misses, 0u);
+}
+
+void VariantCache::add(const Entry& e) {
+   AutoLocker al(l);
+
+   if (misses >= QORE_VARIANT_CACHE_MAX_MISSES) {
+      // megamorphic call sites are not cached any further unless the function that made the call site megamorphic
+      // has changed
+      if (e.func != mfunc || e.gen == mgen)
+         return;
+      clear();
+   }
+   else {
+      // if the function has changed, then all entries for the function are stale and the cache is cleared
+      for (unsigned i = 0; i < QORE_VARIANT_CACHE_SIZE; ++i) {
+         if (seq[i] && entry[i].func == e.func && entry[i].gen != e.gen) {
+            clear();
+            break;
+         }
+      }
+   }
+
+   if (misses + 1 == QORE_VARIANT_CACHE_MAX_MISSES) {
+      // the function must be set before the call site is seen as megamorphic
+      qore_atomic_store(&mfunc, e.func);
+      qore_atomic_store(&mgen, e.gen);
+      qore_atomic_fence_release();
+   }
+   qore_atomic_store(&misses, misses + 1);
+
+   store(next, e);
+   next = (next + 1) % QORE_VARIANT_CACHE_SIZE;
+}
+
+const AbstractQoreFunctionVariant* VariantCache::findVariant(const QoreFunction* func, const QoreValueList* args, ExceptionSink* xsink) {
+   unsigned nargs = args ? args->size() : 0;
+   if (nargs > QORE_VARIANT_CACHE_MAX_ARGS) {
+      thread_variant_cache_miss();
+      return func->findVariant(args, false, xsink);
+   }
+
+   // the generation must be read before the variant is searched
+   Entry key;
+   key.gen = func->getVariantGeneration();
+
+   // megamorphic call sites are not searched unless the function that made the call site megamorphic has changed
+   if (qore_atomic_load_acquire(&misses) >= QORE_VARIANT_CACHE_MAX_MISSES
+       && (qore_atomic_load(&mfunc) != func || qore_atomic_load(&mgen) == key.gen)) {
+      thread_variant_cache_miss();
+      return func->findVariant(args, false, xsink);
+   }
+
+   key.po = runtime_get_parse_options();
+   if (key.set(func, args, nargs)) {
+      const qore_class_private* ctx = runtime_get_class();
+      if (ctx)
+         key.ctx = ctx->serial;
+   }
+
+   for (unsigned i = 0; i < QORE_VARIANT_CACHE_SIZE; ++i) {
+      unsigned s = qore_atomic_load_acquire(&seq[i]);
+      if (!s)
+         break;
+      // skip slots being written
+      if (s & 1)
+         continue;
+      bool match = (entry[i] == key);
+      const AbstractQoreFunctionVariant* v = entry[i].variant;
+      // the entry is only valid if the slot was not written while it was read
+      qore_atomic_fence_acquire();
+      if (match && qore_atomic_load(&seq[i]) == s) {
+         thread_variant_cache_hit();
+         return v;
+      }
+   }
+
+   thread_variant_cache_miss();
+
+   key.variant = func->findVariant(args, false, xsink);
+   // only variants found without errors are cached
+   if (key.variant && !*xsink)
+      add(key);
+   return key.variant;
+}
+
+void MethodCache::add(unsigned serial, const QoreMethod* m, bool priv_flag, unsigned gen) {
+   // megamorphic call sites are not cached any further unless the generation changes
+   if (qore_atomic_load(&misses) >= QORE_VARIANT_CACHE_MAX_MISSES && qore_atomic_load(&cgen) == gen)
+      return;
+
+   AutoLocker al(l);
+   // methods found with an older generation are not cached
+   if (gen < cgen)
+      return;
+
+   // if the generation has changed, then all entries are stale: the cache is cleared and the call site is no longer
+   // treated as megamorphic
+   if (gen > cgen) {
+      for (unsigned i = 0; i < QORE_METHOD_CACHE_SIZE && seq[i]; ++i) {
+         unsigned s = seq[i];
+         qore_atomic_store(&seq[i], s + 1);
+         qore_atomic_fence_release();
+         entry[i].serial = 0;
+         qore_atomic_store_release(&seq[i], s + 2);
+      }
+      next = 0;
+      qore_atomic_store(&misses, 0u);
+      qore_atomic_store(&cgen, gen);
+   }
+   else if (misses >= QORE_VARIANT_CACHE_MAX_MISSES)
+      return;
+
+   qore_atomic_store(&misses, misses + 1);
+
+   unsigned s = seq[next];
+   qore_atomic_store(&seq[next], s + 1);
+   qore_atomic_fence_release();
+   entry[next].method = m;
+   entry[next].serial = serial;
+   entry[next].gen = gen;
+   entry[next].priv_flag = priv_flag;
+   qore_atomic_store_release(&seq[next], s + 2);
+   next = (next + 1) % QORE_METHOD_CACHE_SIZE;
+}
+
 bool AbstractFunctionSignature::operator==(const AbstractFunctionSignature& sig) const {
    if (num_param_types != sig.num_param_types || min_param_types != sig.min_param_types) {
       //printd(5, "AbstractFunctionSignature::operator==() pt: %d != %d || mpt %d != %d\n", num_param_types, sig.num_param_types, min_param_types, sig.min_param_types);
@@ -110,7 +285,7 @@ static void add_args(QoreStringNode &desc, const QoreValueList* args) {
    }
 }
 
-CodeEvaluationHelper::CodeEvaluationHelper(ExceptionSink* n_xsink, const QoreFunction* func, const AbstractQoreFunctionVariant*& variant, const char* n_name, const QoreListNode* args, const char* n_class_name, qore_call_t n_ct, bool is_copy)
+CodeEvaluationHelper::CodeEvaluationHelper(ExceptionSink* n_xsink, const QoreFunction* func, const AbstractQoreFunctionVariant*& variant, const char* n_name, const QoreListNode* args, const char* n_class_name, qore_call_t n_ct, bool is_copy, VariantCache* vc)
    : ct(n_ct), name(n_name), xsink(n_xsink), class_name(n_class_name), loc(RunTimeLocation), tmp(n_xsink), returnTypeInfo((const QoreTypeInfo* )-1), pgm(getProgram()), rtflags(0) {
    tmp.assignEval(args);
 
@@ -119,7 +294,7 @@ CodeEvaluationHelper::CodeEvaluationHelper(ExceptionSink* n_xsink, const QoreFun
 
    bool check_args = variant;
    if (!variant) {
-      variant = func->findVariant(getArgs(), false, xsink);
+      variant = vc ? vc->findVariant(func, getArgs(), xsink) : func->findVariant(getArgs(), false, xsink);
       if (!variant) {
 	 assert(*xsink);
 	 return;
@@ -1135,9 +1310,9 @@ const AbstractQoreFunctionVariant* QoreFunction::parseFindVariant(const QoreProg
 }
 
 // if the variant was identified at parse time, then variant will not be NULL, otherwise if NULL, then it is identified at run time
-QoreValue QoreFunction::evalFunction(const AbstractQoreFunctionVariant* variant, const QoreListNode* args, QoreProgram *pgm, ExceptionSink* xsink) const {
+QoreValue QoreFunction::evalFunction(const AbstractQoreFunctionVariant* variant, const QoreListNode* args, QoreProgram *pgm, ExceptionSink* xsink, VariantCache* vc) const {
    const char* fname = getName();
-   CodeEvaluationHelper ceh(xsink, this, variant, fname, args);
+   CodeEvaluationHelper ceh(xsink, this, variant, fname, args, 0, CT_UNUSED, false, vc);
    if (*xsink) return QoreValue();
 
    ProgramThreadCountContextHelper tch(xsink, pgm, true);
@@ -1630,7 +1805,10 @@ void QoreFunction::parseCommit() {
       else if (!has_builtin)
 	 has_builtin = true;
    }
-   pending_vlist.clear();
+   if (!pending_vlist.empty()) {
+      pending_vlist.clear();
+      variantsChanged();
+   }
 
    if (!parse_same_return_type && same_return_type)
       same_return_type = false;
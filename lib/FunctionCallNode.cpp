@@ -50,10 +50,11 @@ QoreValue AbstractMethodCallNode::exec(QoreObject* o, const char* c_str, Excepti
       assert(method);
       return variant
 	 ? qore_method_private::evalNormalVariant(*method, o, reinterpret_cast<const QoreExternalMethodVariant*>(variant), args, xsink)
-	 : qore_method_private::eval(*method, o, args, xsink);
+	 : qore_method_private::eval(*method, o, args, xsink, getVariantCache());
    }
-   //printd(5, "AbstractMethodCallNode::exec() calling QoreObject::evalMethod() for %s::%s()\n", o->getClassName(), c_str);
-   return o->evalMethodValue(c_str, args, xsink);
+   //printd(5, "AbstractMethodCallNode::exec() calling qore_class_private::evalMethod() for %s::%s()\n", o->getClassName(), c_str);
+   // otherwise the method is found with the call-site cache, which is keyed by the runtime class
+   return qore_class_private::get(*o->getClass())->evalMethod(o, c_str, args, xsink, getMethodCache(), getVariantCache());
 }
 
 static void invalid_access(QoreFunction* func) {
@@ -285,7 +286,7 @@ QoreString* FunctionCallNode::getAsString(bool& del, int foff, ExceptionSink* xs
 // eval(): return value requires a deref(xsink)
 QoreValue FunctionCallNode::evalValueImpl(bool& needs_deref, ExceptionSink* xsink) const {
    //printd(5, "FunctionCallNode::evalImpl() calling %s() current pgm: %p new pgm: %p\n", func->getName(), ::getProgram(), pgm);
-   return func->evalFunction(variant, args, pgm, xsink);
+   return func->evalFunction(variant, args, pgm, xsink, variant ? 0 : getVariantCache());
 }
 
 AbstractQoreNode* FunctionCallNode::parseInitImpl(LocalVar* oflag, int pflag, int& lvids, const QoreTypeInfo*& returnTypeInfo) {
@@ -480,7 +481,7 @@ QoreValue MethodCallNode::execPseudo(const AbstractQoreNode* n, ExceptionSink* x
    if (is_nothing(n) && qc != QC_PSEUDONOTHING)
       return qore_class_private::evalPseudoMethod(QC_PSEUDONOTHING, n, method->getName(), args, xsink);
    else
-      return qore_class_private::evalPseudoMethod(qc, method, variant, n, args, xsink);
+      return qore_class_private::evalPseudoMethod(qc, method, variant, n, args, xsink, variant ? 0 : getVariantCache());
 }
 
 AbstractQoreNode* StaticMethodCallNode::makeReferenceNodeAndDeref() {
@@ -578,5 +579,5 @@ AbstractQoreNode* StaticMethodCallNode::parseInitImpl(LocalVar* oflag, int pflag
 
 QoreValue StaticMethodCallNode::evalValueImpl(bool& needs_deref, ExceptionSink* xsink) const {
    // FIXME: implement rv as QoreValue
-   return qore_method_private::eval(*method, 0, args, xsink);
+   return qore_method_private::eval(*method, 0, args, xsink, getVariantCache());
 }
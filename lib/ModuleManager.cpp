@@ -732,6 +732,10 @@ void QoreModuleManager::loadModuleIntern(ExceptionSink& xsink, const char* name,
 	    return;
 	 }
 
+	 // the user module path does not depend on the api tag, so it's only checked once per directory
+	 if (ai)
+	    continue;
+
 	 // build path to user module
 	 str.clear();
 	 str.sprintf("%s" QORE_DIR_SEP_STR "%s.qm", (*w).c_str(), name);
@@ -35,6 +35,7 @@
 #include <qore/intern/qore_program_private.h>
 #include <qore/intern/ql_crypto.h>
 #include <qore/intern/QoreObjectIntern.h>
+#include <qore/intern/QoreHashNodeIntern.h>
 
 #include <string.h>
 #include <stdlib.h>
@@ -472,6 +473,8 @@ qore_class_private::qore_class_private(QoreClass* n_cls, const char* nme, int64
      pend_priv_const(this),  // pending private constants
      pub_const(this),        // committed public constants
      priv_const(this),       // committed private constants
+     member_keys(0),
+     pending_member_keys(0),
      system_constructor(0),
      constructor(0),
      destructor(0),
@@ -497,6 +500,7 @@ qore_class_private::qore_class_private(QoreClass* n_cls, const char* nme, int64
      pub(false),
      final(false),
      inject(false),
+     has_committed(false),
      domain(dom),
      num_methods(0),
      num_user_methods(0),
@@ -507,7 +511,8 @@ qore_class_private::qore_class_private(QoreClass* n_cls, const char* nme, int64
      selfid("self", typeInfo),
      ptr(0),
      new_copy(0),
-     spgm(0) {
+     spgm(0),
+     serial(qore_cache_serial_next()) {
    assert(methodID == classID);
 
    if (nme)
@@ -529,6 +534,8 @@ qore_class_private::qore_class_private(const qore_class_private& old, QoreClass*
      pend_priv_const(this),             // pending private constants
      pub_const(old.pub_const, 0, this),    // committed public constants
      priv_const(old.priv_const, 0, this),  // committed private constants
+     member_keys(0),
+     pending_member_keys(0),
      system_constructor(old.system_constructor ? old.system_constructor->copy(cls) : 0),
      constructor(0), // method pointers set below when methods are copied
      destructor(0),
@@ -553,6 +560,7 @@ qore_class_private::qore_class_private(const qore_class_private& old, QoreClass*
      pub(false), // the public flag must be explicitly set if necessary after this constructor
      final(old.final),
      inject(old.inject),
+     has_committed(true),
      domain(old.domain),
      num_methods(old.num_methods),
      num_user_methods(old.num_user_methods),
@@ -564,7 +572,8 @@ qore_class_private::qore_class_private(const qore_class_private& old, QoreClass*
      hash(old.hash),
      ptr(old.ptr),
      new_copy(0),
-     spgm(old.spgm ? old.spgm->programRefSelf() : 0) {
+     spgm(old.spgm ? old.spgm->programRefSelf() : 0),
+     serial(qore_cache_serial_next()) {
    QORE_TRACE("qore_class_private::qore_class_private(const qore_class_private& old)");
    printd(5, "qore_class_private::qore_class_private() this: %p creating copy of '%s' ID:%d cls: %p old: %p\n", this, name.c_str(), classID, cls, old.cls);
 
@@ -611,6 +620,12 @@ qore_class_private::qore_class_private(const qore_class_private& old, QoreClass*
    for (member_map_t::const_iterator i = old.members.begin(), e = old.members.end(); i != e; ++i)
       members[strdup(i->first)] = i->second->copy(this);
 
+   // the copied members have the same slots
+   if (old.member_keys) {
+      member_keys = old.member_keys;
+      member_keys->ROreference();
+   }
+
    // copy static var list
    for (var_map_t::const_iterator i = old.vars.begin(), e = old.vars.end(); i != e; ++i)
       vars[strdup(i->first)] = i->second->copy();
@@ -637,6 +652,11 @@ qore_class_private::~qore_class_private() {
       delete i->second;
    }
 
+   if (member_keys)
+      member_keys->deref();
+   if (pending_member_keys)
+      pending_member_keys->deref();
+
    delete scl;
    delete system_constructor;
 
@@ -760,7 +780,7 @@ int qore_class_private::initializeIntern(qcp_set_t& qcp_set) {
                // now we import the abstract method to our class
                AbstractMethod* m = new AbstractMethod;
                // see if there are pending normal variants...
-               hm_method_t::iterator mi = hm.find(j->first);
+               hm_method_t::iterator mi = hm.find(j->first.c_str());
                // merge committed parent abstract variants with any pending local variants
                m->parseMergeBase((*j->second), mi == hm.end() ? 0 : mi->second->getFunction(), true);
                //if (m->vlist.empty())
@@ -872,16 +892,75 @@ const QoreMethod* qore_class_private::findLocalCommittedStaticMethod(const char*
    return m && !m->priv->func->committedEmpty() ? m : 0;
 }
 
+// adds a member to a member key table if it's not already present
+static void add_member_key(qore_hash_keys& kt, const char* mem) {
+   if (kt.find(mem) == qore_hash_private::npos)
+      kt.add(mem, qore_hash_str()(mem));
+}
+
+void qore_class_private::parseInitMemberKeys() {
+   assert(!pending_member_keys);
+   // members imported from base classes are added to the committed member map directly
+   if (pending_members.empty() && (member_keys ? member_keys->size() == members.size() : members.empty()))
+      return;
+
+   qore_hash_keys* kt = member_keys ? new qore_hash_keys(*member_keys) : new qore_hash_keys;
+
+   // a new table starts with the members of the first base class in the same order, so slots resolved in the base
+   // class's methods are also valid for objects of this class
+   if (!member_keys && scl && !scl->empty() && scl->front()->sclass) {
+      const qore_class_private* bqc = scl->front()->sclass->priv;
+      const qore_hash_keys* bkt = bqc->pending_member_keys ? bqc->pending_member_keys : bqc->member_keys;
+      if (bkt) {
+         for (qhkey_vec_t::const_iterator i = bkt->keys.begin(), e = bkt->keys.end(); i != e; ++i) {
+            const char* mem = i->key.c_str();
+            if (members.inList(mem) || pending_members.inList(mem))
+               add_member_key(*kt, mem);
+         }
+      }
+   }
+
+   for (member_map_t::const_iterator i = members.begin(), e = members.end(); i != e; ++i) {
+      if (i->second)
+         add_member_key(*kt, i->first);
+   }
+   for (member_map_t::const_iterator i = pending_members.begin(), e = pending_members.end(); i != e; ++i) {
+      if (i->second)
+         add_member_key(*kt, i->first);
+   }
+
+   if (member_keys && kt->size() == member_keys->size()) {
+      kt->deref();
+      return;
+   }
+   pending_member_keys = kt;
+}
+
+size_t qore_class_private::parseGetMemberSlot(const char* mem) const {
+   const qore_hash_keys* kt = pending_member_keys ? pending_member_keys : member_keys;
+   return kt ? kt->find(mem) : qore_hash_private::npos;
+}
+
+void qore_class_private::initMemberKeys(QoreObject& o) const {
+   // the table is out of date if the class is instantiated while new members are being parsed
+   if (member_keys && member_keys->size() == members.size())
+      qore_object_private::setMemberKeys(o, member_keys);
+}
+
 int qore_class_private::initMembers(QoreObject& o, bool& need_scan, ExceptionSink* xsink) const {
    if (members.empty())
       return 0;
 
+   // give declared members their fixed slots in the object's member hash
+   initMemberKeys(o);
+
    // make sure the object context is set before evaluating members
    CodeContextHelper cch("constructor", &o, xsink);
    SelfInstantiatorHelper sih(&selfid, &o);
 
    for (member_map_t::const_iterator i = members.begin(), e = members.end(); i != e; ++i) {
       if (i->second) {
+	 // create the member before evaluating the initializer to maintain the declaration order
 	 AbstractQoreNode** v = o.getMemberValuePtrForInitialization(i->first);
 	 assert(!*v);
 	 if (i->second->exp) {
@@ -892,6 +971,8 @@ int qore_class_private::initMembers(QoreObject& o, bool& need_scan, ExceptionSin
 	    AbstractQoreNode* nv = i->second->getTypeInfo()->acceptInputMember(i->first, *val, xsink);
 	    if (*xsink)
 	       return -1;
+	    // get the value pointer again; the initializer may have added members to the object
+	    v = o.getMemberValuePtrForInitialization(i->first);
 	    *v = nv;
 	    val.release();
 	    if (get_container_obj(nv)) {
@@ -1023,6 +1104,9 @@ void qore_class_private::parseCommit() {
          }
       }
 
+      // set if methods are added to the class
+      bool new_methods = false;
+
       // commit pending "normal" (non-static) method variants
       for (hm_method_t::iterator i = hm.begin(), e = hm.end(); i != e; ++i) {
 	 bool is_new = i->second->priv->func->committedEmpty();
@@ -1034,6 +1118,7 @@ void qore_class_private::parseCommit() {
 	    checkAssignSpecial(i->second);
 	    ++num_methods;
 	    ++num_user_methods;
+	    new_methods = true;
 	 }
       }
 
@@ -1047,9 +1132,14 @@ void qore_class_private::parseCommit() {
 	 if (is_new) {
 	    ++num_static_methods;
 	    ++num_static_user_methods;
+	    new_methods = true;
 	 }
       }
 
+      // methods added to a committed class can change the methods found for the class and its subclasses at runtime
+      if (new_methods && has_committed)
+	 qore_method_cache_invalidate();
+
       // commit abstract method variant list changes
       ahm.parseCommit();
 
@@ -1064,6 +1154,14 @@ void qore_class_private::parseCommit() {
 	 }
       }
 
+      // commit the member key table with the new members
+      if (pending_member_keys) {
+         if (member_keys)
+            member_keys->deref();
+         member_keys = pending_member_keys;
+         pending_member_keys = 0;
+      }
+
       if (has_sig_changes) {
 	 // add all committed static vars to signature
 	 for (var_map_t::iterator i = vars.begin(), e = vars.end(); i != e; ++i) {
@@ -1133,6 +1231,9 @@ void qore_class_private::parseCommit() {
    // running parseCommit())
    if (!has_public_memdecl && (scl ? scl->parseHasPublicMembersInHierarchy() : false))
       has_public_memdecl = true;
+
+   if (!has_committed)
+      has_committed = true;
 }
 
 void qore_class_private::parseCommitRuntimeInit(ExceptionSink* xsink) {
@@ -2092,8 +2193,10 @@ void qore_class_private::parseRollback() {
    for (hm_method_t::iterator i = hm.begin(), e = hm.end(); i != e;) {
       // if there are no committed variants, then the method must be deleted
       if (i->second->priv->func->committedEmpty()) {
-	 delete i->second;
+	 // the method's name is the key, so the entry must be removed before the method is deleted
+	 QoreMethod* m = i->second;
 	 hm.erase(i++);
+	 delete m;
 	 continue;
       }
 
@@ -2105,8 +2208,10 @@ void qore_class_private::parseRollback() {
    for (hm_method_t::iterator i = shm.begin(), e = shm.end(); i != e;) {
       // if there are no committed variants, then the method must be deleted
       if (i->second->priv->func->committedEmpty()) {
-	 delete i->second;
+	 // the method's name is the key, so the entry must be removed before the method is deleted
+	 QoreMethod* m = i->second;
 	 shm.erase(i++);
+	 delete m;
 	 continue;
       }
 
@@ -2123,6 +2228,12 @@ void qore_class_private::parseRollback() {
 
    assert(pending_vars.empty());
 
+   // discard the member key table with pending members
+   if (pending_member_keys) {
+      pending_member_keys->deref();
+      pending_member_keys = 0;
+   }
+
    // set flags
    if (pending_has_public_memdecl)
       pending_has_public_memdecl = false;
@@ -2412,20 +2523,33 @@ bool qore_class_private::runtimeHasCallableMethod(const char* m, int mask) const
    return !w || (external && priv_flag) ? false : true;
 }
 
-const QoreMethod* qore_class_private::getMethodForEval(const char* nme, QoreProgram* pgm, ExceptionSink* xsink) const {
+const QoreMethod* qore_class_private::runtimeFindMethodForEval(const char* nme, QoreProgram* pgm, bool& priv_flag, ExceptionSink* xsink) const {
+   ProgramRuntimeParseContextHelper pch(xsink, pgm);
+   if (*xsink)
+      return 0;
+
+   const QoreMethod* w = runtimeFindCommittedMethodIntern(nme, priv_flag);
+   return w ? w : runtimeFindCommittedStaticMethodIntern(nme, priv_flag);
+}
+
+const QoreMethod* qore_class_private::getMethodForEval(const char* nme, QoreProgram* pgm, ExceptionSink* xsink, MethodCache* mc) const {
    //printd(5, "qore_class_private::getMethodForEval() %s::%s() %s call attempted\n", name.c_str(), nme, runtimeCheckPrivateClassAccess() ? "external" : "internal" );
 
    const QoreMethod* w;
    bool priv_flag = false;
 
-   {
-      ProgramRuntimeParseContextHelper pch(xsink, pgm);
-      if (*xsink)
-	 return 0;
-
-      if (!(w = runtimeFindCommittedMethodIntern(nme, priv_flag)) && !(w = runtimeFindCommittedStaticMethodIntern(nme, priv_flag)))
-	 return 0;
+   if (mc) {
+      // the generation must be read before the method is searched
+      unsigned gen = qore_atomic_load_acquire(&qore_method_gen);
+      if (!(w = mc->find(serial, gen, priv_flag))) {
+         thread_variant_cache_miss();
+         if (!(w = runtimeFindMethodForEval(nme, pgm, priv_flag, xsink)))
+            return 0;
+         mc->add(serial, w, priv_flag, gen);
+      }
    }
+   else if (!(w = runtimeFindMethodForEval(nme, pgm, priv_flag, xsink)))
+      return 0;
 
    //printd(5, "QoreClass::getMethodForEval() %s::%s() found method %p class %s\n", name.c_str(), nme, w, w->getClassName());
 
@@ -2435,6 +2559,7 @@ const QoreMethod* qore_class_private::getMethodForEval(const char* nme, QoreProg
       return 0;
    }
 
+   // access checks depend on the calling context and are therefore made for every call
    if (w->isPrivate() && !runtimeCheckPrivateClassAccess()) {
       xsink->raiseException("METHOD-IS-PRIVATE", "%s::%s() is private and cannot be accessed externally", name.c_str(), nme);
       return 0;
@@ -2449,6 +2574,10 @@ const QoreMethod* qore_class_private::getMethodForEval(const char* nme, QoreProg
 
 QoreValue QoreClass::evalMethod(QoreObject* self, const char* nme, const QoreListNode* args, ExceptionSink* xsink) const {
    QORE_TRACE("QoreClass::evalMethod()");
+   return priv->evalMethod(self, nme, args, xsink);
+}
+
+QoreValue qore_class_private::evalMethod(QoreObject* self, const char* nme, const QoreListNode* args, ExceptionSink* xsink, MethodCache* mc, VariantCache* vc) const {
    assert(self);
 
    if (!strcmp(nme, "copy")) {
@@ -2456,23 +2585,23 @@ QoreValue QoreClass::evalMethod(QoreObject* self, const char* nme, const QoreLis
          xsink->raiseException("COPY-ERROR", "while calling %s::copy(): it is illegal to pass arguments to copy methods", self->getClassName());
          return QoreValue();
       }
-      return execCopy(self, xsink);
+      return cls->execCopy(self, xsink);
    }
 
-   const QoreMethod* w = priv->getMethodForEval(nme, self->getProgram(), xsink);
+   const QoreMethod* w = getMethodForEval(nme, self->getProgram(), xsink, mc);
    if (*xsink)
       return QoreValue();
 
    if (w)
-      return qore_method_private::eval(*w, self, args, xsink);
+      return qore_method_private::eval(*w, self, args, xsink, vc);
 
    // first see if there is a pseudo-method for this
    QoreClass* qc = 0;
    w = pseudo_classes_find_method(NT_OBJECT, nme, qc);
    if (w)
       return qore_method_private::evalPseudoMethod(w, 0, self, args, xsink);
-   else if (priv->methodGate && !priv->methodGate->inMethod(self)) // call methodGate with unknown method name and arguments
-      return evalMethodGate(self, nme, args, xsink);
+   else if (methodGate && !methodGate->inMethod(self)) // call methodGate with unknown method name and arguments
+      return cls->evalMethodGate(self, nme, args, xsink);
 
    xsink->raiseException("METHOD-DOES-NOT-EXIST", "no method %s::%s() has been defined and no pseudo-method <object>::%s() is available", self->getClassName(), nme, nme);
    return QoreValue();
@@ -3300,7 +3429,7 @@ void qore_class_private::parseInitPartialIntern() {
                }
                AbstractMethod* m = new AbstractMethod;
                // see if there are pending normal variants...
-               hm_method_t::iterator mi = hm.find(ai->first);
+               hm_method_t::iterator mi = hm.find(ai->first.c_str());
                //printd(5, "qore_class_private::parseInitPartialIntern() this: %p '%s' looking for local '%s': %d\n", this, name.c_str(), ai->first.c_str(), mi != hm.end());
                m->parseMergeBase(*(ai->second), mi == hm.end() ? 0 : mi->second->getFunction());
 	       if (m->empty())
@@ -3316,6 +3445,9 @@ void qore_class_private::parseInitPartialIntern() {
    if (!has_new_user_changes)
       return;
 
+   // assign slots to new members before any member references are resolved
+   parseInitMemberKeys();
+
    // do processing related to parent classes
    if (scl) {
       // setup inheritance list for new methods
@@ -3487,8 +3619,8 @@ QoreValue qore_class_private::evalPseudoMethod(const QoreValue n, const char* nm
    return qore_method_private::evalPseudoMethod(m, 0, n, args, xsink);
 }
 
-QoreValue qore_class_private::evalPseudoMethod(const QoreMethod* m, const AbstractQoreFunctionVariant* variant, const QoreValue n, const QoreListNode* args, ExceptionSink* xsink) const {
-   return qore_method_private::evalPseudoMethod(m, variant, n, args, xsink);
+QoreValue qore_class_private::evalPseudoMethod(const QoreMethod* m, const AbstractQoreFunctionVariant* variant, const QoreValue n, const QoreListNode* args, ExceptionSink* xsink, VariantCache* vc) const {
+   return qore_method_private::evalPseudoMethod(m, variant, n, args, xsink, vc);
 }
 
 bool qore_class_private::parseCheckPrivateClassAccess() const {
@@ -3690,6 +3822,7 @@ void MethodFunctionBase::parseRollback() {
       for (vlist_t::iterator i = pending_save.begin(), e = pending_save.end(); i != e; ++i)
 	 vlist.push_back(*i);
       pending_save.clear();
+      variantsChanged();
    }
 }
 
@@ -3823,6 +3956,7 @@ void MethodFunctionBase::replaceAbstractVariantIntern(MethodVariantBase* variant
 	 pending_save.push_back(*i);
 	 vlist.erase(i);
 	 vlist.push_back(variant);
+	 variantsChanged();
 	 //printd(5, "MethodFunctionBase::replaceAbstractVariantIntern() this: %p replacing %p ::%s%s in vlist\n", this, variant, getName(), variant->getAbstractSignature());
 	 return;
       }
@@ -4021,10 +4155,10 @@ void DestructorMethodFunction::evalDestructor(const QoreClass& thisclass, QoreOb
 }
 
 // if the variant was identified at parse time, then variant will not be NULL, otherwise if NULL then it is identified at run time
-QoreValue NormalMethodFunction::evalMethod(const AbstractQoreFunctionVariant* variant, QoreObject* self, const QoreListNode* args, ExceptionSink* xsink) const {
+QoreValue NormalMethodFunction::evalMethod(const AbstractQoreFunctionVariant* variant, QoreObject* self, const QoreListNode* args, ExceptionSink* xsink, VariantCache* vc) const {
    bool had_variant = (bool)variant;
    const char* mname = getName();
-   CodeEvaluationHelper ceh(xsink, this, variant, mname, args, getClassName());
+   CodeEvaluationHelper ceh(xsink, this, variant, mname, args, getClassName(), CT_UNUSED, false, vc);
    if (*xsink) return QoreValue();
 
    const MethodVariant* mv = METHV_const(variant);
@@ -4042,9 +4176,9 @@ QoreValue NormalMethodFunction::evalMethod(const AbstractQoreFunctionVariant* va
 }
 
 // if the variant was identified at parse time, then variant will not be NULL, otherwise if NULL then it is identified at run time
-QoreValue NormalMethodFunction::evalPseudoMethod(const AbstractQoreFunctionVariant* variant, const QoreValue n, const QoreListNode* args, ExceptionSink* xsink) const {
+QoreValue NormalMethodFunction::evalPseudoMethod(const AbstractQoreFunctionVariant* variant, const QoreValue n, const QoreListNode* args, ExceptionSink* xsink, VariantCache* vc) const {
    const char* mname = getName();
-   CodeEvaluationHelper ceh(xsink, this, variant, mname, args, getClassName());
+   CodeEvaluationHelper ceh(xsink, this, variant, mname, args, getClassName(), CT_UNUSED, false, vc);
    if (*xsink)
       return QoreValue();
 
@@ -4052,9 +4186,9 @@ QoreValue NormalMethodFunction::evalPseudoMethod(const AbstractQoreFunctionVaria
 }
 
 // if the variant was identified at parse time, then variant will not be NULL, otherwise if NULL then it is identified at run time
-QoreValue StaticMethodFunction::evalMethod(const AbstractQoreFunctionVariant* variant, const QoreListNode* args, ExceptionSink* xsink) const {
+QoreValue StaticMethodFunction::evalMethod(const AbstractQoreFunctionVariant* variant, const QoreListNode* args, ExceptionSink* xsink, VariantCache* vc) const {
    const char* mname = getName();
-   CodeEvaluationHelper ceh(xsink, this, variant, mname, args, getClassName());
+   CodeEvaluationHelper ceh(xsink, this, variant, mname, args, getClassName(), CT_UNUSED, false, vc);
    if (*xsink) return QoreValue();
 
    return METHV_const(variant)->evalMethod(0, ceh, xsink);
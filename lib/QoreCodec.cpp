@@ -0,0 +1,361 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+  QoreCodec.cpp
+
+  base64 and hex encoding and decoding
+
+  Qore Programming Language
+
+  Copyright (C) 2003 - 2015 David Nichols
+
+  Permission is hereby granted, free of charge, to any person obtaining a
+  copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+  DEALINGS IN THE SOFTWARE.
+
+  Note that the Qore library is released under a choice of three open-source
+  licenses: MIT (as above), LGPL 2+, or GPL 2+; see README-LICENSE for more
+  information.
+*/
+
+#include <qore/Qore.h>
+#include <qore/intern/QoreCodec.h>
+
+#include <string.h>
+
+// the SSSE3 and AVX2 functions are compiled with target attributes and selected at runtime according to the CPU, so
+// the library can be built for generic x86 CPUs; this requires compiler support for intrinsics in such functions
+#if (defined(__x86_64__) || defined(__i386__)) \
+   && ((defined(__clang__) && (defined(__apple_build_version__) ? __clang_major__ >= 8 : (__clang_major__ > 3 || (__clang_major__ == 3 && __clang_minor__ >= 8)))) \
+       || (!defined(__clang__) && defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define QORE_CODEC_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+const signed char q_base64_dec[256] = {
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+   52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+   -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+   15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+   -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+   41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+// hex digit values; -1 for invalid digits
+static const signed char hex_dec[256] = {
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+   -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+static const char hex_digits[] = "0123456789abcdef";
+
+#ifdef QORE_CODEC_X86_DISPATCH
+#define QORE_CODEC_NONE  0
+#define QORE_CODEC_SSSE3 1
+#define QORE_CODEC_AVX2  2
+
+static int get_codec_level() {
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx2"))
+      return QORE_CODEC_AVX2;
+   if (__builtin_cpu_supports("ssse3"))
+      return QORE_CODEC_SSSE3;
+   return QORE_CODEC_NONE;
+}
+
+// the SIMD level supported by the CPU; zero (scalar code only) until initialized
+static int q_codec_level = get_codec_level();
+
+// base64 encoding with SSSE3 and AVX2 after:
+// W. Muła, D. Lemire: "Faster Base64 Encoding and Decoding Using AVX2 Instructions", ACM TOW 2018
+// 12 bytes in the low 12 bytes of each 128-bit lane are converted to 16 6-bit values and then to base64 digits
+
+__attribute__((target("ssse3")))
+static qore_size_t base64_encode_ssse3(char* dst, const unsigned char* src, qore_size_t size) {
+   const __m128i enc_shuf = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+   const __m128i enc_lut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                         '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+   qore_size_t i = 0;
+   // 16 bytes are read for every 12 bytes encoded
+   for (; i + 16 <= size; i += 12, dst += 16) {
+      __m128i in = _mm_loadu_si128((const __m128i*)(src + i));
+      // each 32-bit word gets the bytes of one 3-byte group, whose 6-bit values are then shifted into separate bytes
+      in = _mm_shuffle_epi8(in, enc_shuf);
+      in = _mm_or_si128(_mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040)),
+                        _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010)));
+      // translate the 6-bit values to ASCII with an offset selected for each range of values
+      __m128i r = _mm_subs_epu8(in, _mm_set1_epi8(51));
+      r = _mm_or_si128(r, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), in), _mm_set1_epi8(13)));
+      r = _mm_add_epi8(_mm_shuffle_epi8(enc_lut, r), in);
+      _mm_storeu_si128((__m128i*)dst, r);
+   }
+   return i;
+}
+
+__attribute__((target("avx2")))
+static qore_size_t base64_encode_avx2(char* dst, const unsigned char* src, qore_size_t size) {
+   const __m128i s = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+   const __m256i enc_shuf = _mm256_inserti128_si256(_mm256_castsi128_si256(s), s, 1);
+   const __m128i l = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                   '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+   const __m256i enc_lut = _mm256_inserti128_si256(_mm256_castsi128_si256(l), l, 1);
+   qore_size_t i = 0;
+   // 28 bytes are read for every 24 bytes encoded
+   for (; i + 28 <= size; i += 24, dst += 32) {
+      __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(src + i))),
+                                           _mm_loadu_si128((const __m128i*)(src + i + 12)), 1);
+      in = _mm256_shuffle_epi8(in, enc_shuf);
+      in = _mm256_or_si256(_mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040)),
+                           _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010)));
+      __m256i r = _mm256_subs_epu8(in, _mm256_set1_epi8(51));
+      r = _mm256_or_si256(r, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), in), _mm256_set1_epi8(13)));
+      r = _mm256_add_epi8(_mm256_shuffle_epi8(enc_lut, r), in);
+      _mm256_storeu_si256((__m256i*)dst, r);
+   }
+   return i;
+}
+
+// base64 decoding: characters are validated and translated with tables indexed by their high and low nibbles; 16
+// characters in each 128-bit lane are converted to 12 bytes
+#define B64_DEC_LUT_LO 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a
+#define B64_DEC_LUT_HI 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+#define B64_DEC_LUT_ROLL 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0
+#define B64_DEC_PACK 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+
+__attribute__((target("ssse3")))
+static qore_size_t base64_decode_ssse3(unsigned char* dst, const char* src, qore_size_t len, qore_size_t& used) {
+   const __m128i lut_lo = _mm_setr_epi8(B64_DEC_LUT_LO);
+   const __m128i lut_hi = _mm_setr_epi8(B64_DEC_LUT_HI);
+   const __m128i lut_roll = _mm_setr_epi8(B64_DEC_LUT_ROLL);
+   const __m128i pack = _mm_setr_epi8(B64_DEC_PACK);
+   const __m128i mask = _mm_set1_epi8(0x0f);
+
+   qore_size_t i = 0, o = 0;
+   for (; i + 16 <= len; i += 16, o += 12) {
+      __m128i in = _mm_loadu_si128((const __m128i*)(src + i));
+      __m128i hi = _mm_and_si128(_mm_srli_epi32(in, 4), mask);
+      __m128i lo = _mm_and_si128(in, mask);
+      if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(_mm_shuffle_epi8(lut_lo, lo), _mm_shuffle_epi8(lut_hi, hi)), _mm_setzero_si128())))
+         break;
+      __m128i eq_2f = _mm_cmpeq_epi8(in, _mm_set1_epi8(0x2f));
+      in = _mm_add_epi8(in, _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi)));
+      // merge the 6-bit values into 24-bit groups and store them in big-endian order
+      in = _mm_madd_epi16(_mm_maddubs_epi16(in, _mm_set1_epi32(0x01400140)), _mm_set1_epi32(0x00011000));
+      _mm_storeu_si128((__m128i*)(dst + o), _mm_shuffle_epi8(in, pack));
+   }
+   used = i;
+   return o;
+}
+
+__attribute__((target("avx2")))
+static qore_size_t base64_decode_avx2(unsigned char* dst, const char* src, qore_size_t len, qore_size_t& used) {
+   const __m128i l = _mm_setr_epi8(B64_DEC_LUT_LO);
+   const __m256i lut_lo = _mm256_inserti128_si256(_mm256_castsi128_si256(l), l, 1);
+   const __m128i h = _mm_setr_epi8(B64_DEC_LUT_HI);
+   const __m256i lut_hi = _mm256_inserti128_si256(_mm256_castsi128_si256(h), h, 1);
+   const __m128i r = _mm_setr_epi8(B64_DEC_LUT_ROLL);
+   const __m256i lut_roll = _mm256_inserti128_si256(_mm256_castsi128_si256(r), r, 1);
+   const __m128i p = _mm_setr_epi8(B64_DEC_PACK);
+   const __m256i pack = _mm256_inserti128_si256(_mm256_castsi128_si256(p), p, 1);
+   const __m256i mask = _mm256_set1_epi8(0x0f);
+   // moves the 12 bytes of each lane together
+   const __m256i perm = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+
+   qore_size_t i = 0, o = 0;
+   for (; i + 32 <= len; i += 32, o += 24) {
+      __m256i in = _mm256_loadu_si256((const __m256i*)(src + i));
+      __m256i hi = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask);
+      __m256i lo = _mm256_and_si256(in, mask);
+      if (_mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_and_si256(_mm256_shuffle_epi8(lut_lo, lo), _mm256_shuffle_epi8(lut_hi, hi)), _mm256_setzero_si256())))
+         break;
+      __m256i eq_2f = _mm256_cmpeq_epi8(in, _mm256_set1_epi8(0x2f));
+      in = _mm256_add_epi8(in, _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi)));
+      in = _mm256_madd_epi16(_mm256_maddubs_epi16(in, _mm256_set1_epi32(0x01400140)), _mm256_set1_epi32(0x00011000));
+      in = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(in, pack), perm);
+      _mm256_storeu_si256((__m256i*)(dst + o), in);
+   }
+   used = i;
+   return o;
+}
+#endif
+
+#ifdef __SSE2__
+// converts 16 nibbles to lowercase hex digits
+static inline __m128i hex_digits_sse2(__m128i v) {
+   __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(9)), _mm_set1_epi8('a' - '0' - 10));
+   return _mm_add_epi8(_mm_add_epi8(v, _mm_set1_epi8('0')), alpha);
+}
+
+static qore_size_t hex_encode_sse2(char* dst, const unsigned char* src, qore_size_t size) {
+   const __m128i mask = _mm_set1_epi8(0x0f);
+   qore_size_t i = 0;
+   for (; i + 16 <= size; i += 16, dst += 32) {
+      __m128i in = _mm_loadu_si128((const __m128i*)(src + i));
+      __m128i hi = hex_digits_sse2(_mm_and_si128(_mm_srli_epi16(in, 4), mask));
+      __m128i lo = hex_digits_sse2(_mm_and_si128(in, mask));
+      _mm_storeu_si128((__m128i*)dst, _mm_unpacklo_epi8(hi, lo));
+      _mm_storeu_si128((__m128i*)(dst + 16), _mm_unpackhi_epi8(hi, lo));
+   }
+   return i;
+}
+
+// converts 16 hex digits to their values in the low byte of each 16-bit pair (high nibble first); sets ok to false if
+// any digit is invalid
+static inline __m128i hex_values_sse2(__m128i in, bool& ok) {
+   // digits and letters are found by checking for an offset in range as an unsigned value
+   __m128i d = _mm_sub_epi8(in, _mm_set1_epi8('0'));
+   __m128i is_d = _mm_cmpeq_epi8(_mm_max_epu8(d, _mm_set1_epi8(9)), _mm_set1_epi8(9));
+   __m128i a = _mm_sub_epi8(_mm_or_si128(in, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+   __m128i is_a = _mm_cmpeq_epi8(_mm_max_epu8(a, _mm_set1_epi8(5)), _mm_set1_epi8(5));
+   ok = _mm_movemask_epi8(_mm_or_si128(is_d, is_a)) == 0xffff;
+   __m128i v = _mm_or_si128(_mm_and_si128(is_d, d), _mm_and_si128(is_a, _mm_add_epi8(a, _mm_set1_epi8(10))));
+   return _mm_or_si128(_mm_slli_epi16(_mm_and_si128(v, _mm_set1_epi16(0x00ff)), 4), _mm_srli_epi16(v, 8));
+}
+
+static qore_size_t hex_decode_sse2(unsigned char* dst, const char* src, qore_size_t len) {
+   qore_size_t i = 0;
+   for (; i + 32 <= len; i += 32, dst += 16) {
+      bool ok0, ok1;
+      __m128i v0 = hex_values_sse2(_mm_loadu_si128((const __m128i*)(src + i)), ok0);
+      __m128i v1 = hex_values_sse2(_mm_loadu_si128((const __m128i*)(src + i + 16)), ok1);
+      if (!ok0 || !ok1)
+         break;
+      _mm_storeu_si128((__m128i*)dst, _mm_packus_epi16(v0, v1));
+   }
+   return i / 2;
+}
+#endif
+
+qore_size_t q_base64_encoded_size(qore_size_t size, qore_size_t maxlinelen) {
+   qore_size_t rc = ((size + 2) / 3) * 4;
+   if (maxlinelen > 0)
+      rc += ((size * 4 + 2) / 3 / maxlinelen) * 2;
+   return rc;
+}
+
+void q_base64_encode(char* dst, const unsigned char* src, qore_size_t size) {
+   qore_size_t i = 0;
+#ifdef QORE_CODEC_X86_DISPATCH
+   if (q_codec_level >= QORE_CODEC_AVX2)
+      i = base64_encode_avx2(dst, src, size);
+   if (q_codec_level >= QORE_CODEC_SSSE3)
+      i += base64_encode_ssse3(dst + (i / 3) * 4, src + i, size - i);
+   dst += (i / 3) * 4;
+#endif
+
+   for (; i + 3 <= size; i += 3, dst += 4) {
+      unsigned v = (src[i] << 16) | (src[i + 1] << 8) | src[i + 2];
+      dst[0] = table64[v >> 18];
+      dst[1] = table64[(v >> 12) & 63];
+      dst[2] = table64[(v >> 6) & 63];
+      dst[3] = table64[v & 63];
+   }
+
+   switch (size - i) {
+      case 1:
+         dst[0] = table64[src[i] >> 2];
+         dst[1] = table64[(src[i] & 3) << 4];
+         dst[2] = '=';
+         dst[3] = '=';
+         break;
+      case 2:
+         dst[0] = table64[src[i] >> 2];
+         dst[1] = table64[((src[i] & 3) << 4) | (src[i + 1] >> 4)];
+         dst[2] = table64[(src[i + 1] & 15) << 2];
+         dst[3] = '=';
+         break;
+   }
+}
+
+qore_size_t q_base64_decode(unsigned char* dst, const char* src, qore_size_t len, qore_size_t& used) {
+   qore_size_t i = 0, o = 0;
+#ifdef QORE_CODEC_X86_DISPATCH
+   if (q_codec_level >= QORE_CODEC_AVX2)
+      o = base64_decode_avx2(dst, src, len, i);
+   if (q_codec_level >= QORE_CODEC_SSSE3) {
+      qore_size_t n;
+      o += base64_decode_ssse3(dst + o, src + i, len - i, n);
+      i += n;
+   }
+#endif
+
+   const unsigned char* p = (const unsigned char*)src;
+   for (; i + 4 <= len; i += 4, o += 3) {
+      int a = q_base64_dec[p[i]], b = q_base64_dec[p[i + 1]], c = q_base64_dec[p[i + 2]], d = q_base64_dec[p[i + 3]];
+      if ((a | b | c | d) < 0)
+         break;
+      dst[o] = (a << 2) | (b >> 4);
+      dst[o + 1] = (b << 4) | (c >> 2);
+      dst[o + 2] = (c << 6) | d;
+   }
+   used = i;
+   return o;
+}
+
+void q_hex_encode(char* dst, const unsigned char* src, qore_size_t size) {
+   qore_size_t i = 0;
+#ifdef __SSE2__
+   i = hex_encode_sse2(dst, src, size);
+   dst += i * 2;
+#endif
+   for (; i < size; ++i) {
+      *dst++ = hex_digits[src[i] >> 4];
+      *dst++ = hex_digits[src[i] & 15];
+   }
+}
+
+qore_size_t q_hex_decode(unsigned char* dst, const char* src, qore_size_t len) {
+   qore_size_t o = 0;
+#ifdef __SSE2__
+   o = hex_decode_sse2(dst, src, len);
+#endif
+   const unsigned char* p = (const unsigned char*)src;
+   for (qore_size_t i = o * 2; i + 2 <= len; i += 2, ++o) {
+      int h = hex_dec[p[i]], l = hex_dec[p[i + 1]];
+      if ((h | l) < 0)
+         break;
+      dst[o] = (h << 4) | l;
+   }
+   return o;
+}
@@ -225,6 +225,8 @@ void QoreFile::makeSpecial(int sfd) {
    priv->charset = QCS_DEFAULT;
    priv->special_file = true;
    priv->fd = sfd;
+   // system files are not buffered so that no data is consumed that could be read by other processes sharing the descriptor
+   priv->rbuf_size = 0;
 }
 
 int QoreFile::open(const char *fn, int flags, int mode, const QoreEncoding *cs) {
@@ -286,12 +288,7 @@ int QoreFile::readUntil(const char* bytes, QoreString& str, bool incl_bytes) {
 }
 
 qore_size_t QoreFile::setPos(qore_size_t pos) {
-   AutoLocker al(priv->m);
-
-   if (!priv->is_open)
-      return -1;
-
-   return lseek(priv->fd, pos, SEEK_SET);
+   return priv->setPos(pos);
 }
 
 // FIXME: deleteme
@@ -783,6 +780,14 @@ bool QoreFile::isDataAvailable(int timeout_ms, ExceptionSink *xsink) const {
    return priv->isDataAvailable(timeout_ms, xsink);
 }
 
+int QoreFile::setReadBufferSize(qore_size_t size, ExceptionSink* xsink) {
+   return priv->setReadBufferSize(size, xsink);
+}
+
+qore_size_t QoreFile::getReadBufferSize() const {
+   return priv->getReadBufferSize();
+}
+
 int QoreFile::getFD() const {
    return priv->fd;
 }
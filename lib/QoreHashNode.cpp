@@ -246,6 +246,10 @@ QoreHashNode* QoreHashNode::copy() const {
    return priv->copy();
 }
 
+QoreHashNode* QoreHashNode::copyKeys() const {
+   return priv->copyKeys();
+}
+
 QoreHashNode* QoreHashNode::hashRefSelf() const {
    ref();
    return const_cast<QoreHashNode*>(this);
@@ -288,10 +292,10 @@ AbstractQoreNode* QoreHashNode::evalKeyValue(const QoreString* key, ExceptionSin
    if (*xsink)
       return 0;
 
-   hm_hm_t::const_iterator i = priv->hm.find(k->getBuffer());
+   size_t i = priv->find(k->getBuffer());
 
-   if (i != priv->hm.end() && (*i->second)->node)
-      return (*i->second)->node->refSelf();
+   if (i != qore_hash_private::npos && priv->getValue(i))
+      return priv->getValue(i)->refSelf();
 
    return 0;
 }
@@ -299,10 +303,10 @@ AbstractQoreNode* QoreHashNode::evalKeyValue(const QoreString* key, ExceptionSin
 AbstractQoreNode* QoreHashNode::getReferencedKeyValue(const char* key) const {
    assert(key);
 
-   hm_hm_t::const_iterator i = priv->hm.find(key);
+   size_t i = priv->find(key);
 
-   if (i != priv->hm.end() && (*i->second)->node)
-      return (*i->second)->node->refSelf();
+   if (i != qore_hash_private::npos && priv->getValue(i))
+      return priv->getValue(i)->refSelf();
 
    return 0;
 }
@@ -310,12 +314,12 @@ AbstractQoreNode* QoreHashNode::getReferencedKeyValue(const char* key) const {
 AbstractQoreNode* QoreHashNode::getReferencedKeyValue(const char* key, bool &exists) const {
    assert(key);
 
-   hm_hm_t::const_iterator i = priv->hm.find(key);
+   size_t i = priv->find(key);
 
-   if (i != priv->hm.end()) {
+   if (i != qore_hash_private::npos) {
       exists = true;
-      if ((*i->second)->node)
-	 return (*i->second)->node->refSelf();
+      if (priv->getValue(i))
+	 return priv->getValue(i)->refSelf();
 
       return 0;
    }
@@ -326,10 +330,10 @@ AbstractQoreNode* QoreHashNode::getReferencedKeyValue(const char* key, bool &exi
 AbstractQoreNode* QoreHashNode::getKeyValue(const char* key) {
    assert(key);
 
-   hm_hm_t::const_iterator i = priv->hm.find(key);
+   size_t i = priv->find(key);
 
-   if (i != priv->hm.end())
-      return (*i->second)->node;
+   if (i != qore_hash_private::npos)
+      return priv->getValue(i);
 
    return 0;
 }
@@ -341,11 +345,11 @@ const AbstractQoreNode* QoreHashNode::getKeyValue(const char* key) const {
 AbstractQoreNode* QoreHashNode::getKeyValueExistence(const char* key, bool &exists) {
    assert(key);
 
-   hm_hm_t::const_iterator i = priv->hm.find(key);
+   size_t i = priv->find(key);
 
-   if (i != priv->hm.end()) {
+   if (i != qore_hash_private::npos) {
       exists = true;
-      return (*i->second)->node;
+      return priv->getValue(i);
    }
 
    exists = false;
@@ -364,11 +368,11 @@ bool QoreHashNode::compareSoft(const QoreHashNode* h, ExceptionSink* xsink) cons
 
    ConstHashIterator hi(this);
    while (hi.next()) {
-      hm_hm_t::const_iterator j = h->priv->hm.find(hi.getKey());
-      if (j == h->priv->hm.end())
+      size_t j = h->priv->find(hi.getKey());
+      if (j == qore_hash_private::npos)
          return 1;
 
-      if (q_compare_soft(hi.getValue(), (*j->second)->node, xsink))
+      if (q_compare_soft(hi.getValue(), h->priv->getValue(j), xsink))
          return 1;
    }
    return 0;
@@ -382,11 +386,11 @@ bool QoreHashNode::compareHard(const QoreHashNode* h, ExceptionSink* xsink) cons
 
    ConstHashIterator hi(this);
    while (hi.next()) {
-      hm_hm_t::const_iterator j = h->priv->hm.find(hi.getKey());
-      if (j == h->priv->hm.end())
+      size_t j = h->priv->find(hi.getKey());
+      if (j == qore_hash_private::npos)
          return 1;
 
-      if (::compareHard(hi.getValue(), (*j->second)->node, xsink))
+      if (::compareHard(hi.getValue(), h->priv->getValue(j), xsink))
          return 1;
    }
    return 0;
@@ -394,12 +398,7 @@ bool QoreHashNode::compareHard(const QoreHashNode* h, ExceptionSink* xsink) cons
 
 // deprecated
 AbstractQoreNode** QoreHashNode::getExistingValuePtr(const char* key) {
-   hm_hm_t::const_iterator i = priv->hm.find(key);
-
-   if (i != priv->hm.end())
-      return &(*i->second)->node;
-
-   return 0;
+   return priv->findMember(key);
 }
 
 bool QoreHashNode::derefImpl(ExceptionSink* xsink) {
@@ -560,10 +559,11 @@ bool QoreHashNode::getAsBoolImpl() const {
 
 class qhi_priv {
 public:
-   qhlist_t::iterator i;
+   // position in the hash's tables
+   size_t i;
    bool val;
 
-   DLLLOCAL qhi_priv() : val(false) {
+   DLLLOCAL qhi_priv() : i(qore_hash_private::npos), val(false) {
    }
 
    DLLLOCAL qhi_priv(const qhi_priv& old) : i(old.i), val(old.val) {
@@ -573,36 +573,16 @@ public:
       return val;
    }
 
-   DLLLOCAL bool next(qhlist_t& ml) {
+   DLLLOCAL bool next(const qore_hash_private& h) {
       //printd(0, "qhi_priv::next() this: %p val: %d\n", this, val);
-      if (!val) {
-	 if (ml.begin() != ml.end()) {
-	    i = ml.begin();
-	    val = true;
-	 }
-      }
-      else {
-	 ++i;
-	 if (i == ml.end())
-	    val = false;
-      }
+      i = h.next(val ? i : qore_hash_private::npos);
+      val = i != qore_hash_private::npos;
       return val;
    }
 
-   DLLLOCAL bool prev(qhlist_t& ml) {
-      if (!val) {
-	 if (ml.begin() != ml.end()) {
-	    i = ml.end();
-	    --i;
-	    val = true;
-	 }
-      }
-      else {
-	 if (i == ml.begin())
-	    val = false;
-	 else
-	    --i;
-      }
+   DLLLOCAL bool prev(const qore_hash_private& h) {
+      i = h.prev(val ? i : h.tableSize());
+      val = i != qore_hash_private::npos;
       return val;
    }
 
@@ -622,50 +602,44 @@ HashIterator::~HashIterator() {
 }
 
 AbstractQoreNode* HashIterator::getReferencedValue() const {
-   return !priv->valid() || !(*(priv->i))->node ? 0 : (*(priv->i))->node->refSelf();
+   return !priv->valid() || !h->priv->getValue(priv->i) ? 0 : h->priv->getValue(priv->i)->refSelf();
 }
 
 QoreString* HashIterator::getKeyString() const {
-   return !priv->valid() ? 0 : new QoreString((*(priv->i))->key);
+   return !priv->valid() ? 0 : new QoreString(h->priv->getKey(priv->i));
 }
 
 bool HashIterator::next() {
-   return h ? priv->next(h->priv->member_list) : false;
+   return h ? priv->next(*h->priv) : false;
 }
 
 bool HashIterator::prev() {
-   return h ? priv->prev(h->priv->member_list) : false;
+   return h ? priv->prev(*h->priv) : false;
 }
 
 const char* HashIterator::getKey() const {
    if (!priv->valid())
       return 0;
 
-   return (*(priv->i))->key.c_str();
+   return h->priv->getKey(priv->i).c_str();
 }
 
 AbstractQoreNode* HashIterator::getValue() const {
    if (!priv->valid())
       return 0;
 
-   return (*(priv->i))->node;
+   return h->priv->getValue(priv->i);
 }
 
 AbstractQoreNode* HashIterator::takeValueAndDelete() {
    if (!priv->valid())
       return 0;
 
-   AbstractQoreNode* rv = (*(priv->i))->node;
-   (*(priv->i))->node = 0;
-
-   qhlist_t::iterator ni = priv->i;
-   priv->prev(h->priv->member_list);
+   AbstractQoreNode* rv = h->priv->getValue(priv->i);
 
-   // remove key from map before deleting hash member with key pointer
-   hm_hm_t::iterator i = h->priv->hm.find((*ni)->key.c_str());
-   assert(i != h->priv->hm.end());
-   h->priv->hm.erase(i);
-   h->priv->internDeleteKey(ni);
+   size_t ni = priv->i;
+   priv->prev(*h->priv);
+   h->priv->erase(ni);
 
    return rv;
 }
@@ -674,16 +648,13 @@ void HashIterator::deleteKey(ExceptionSink* xsink) {
    if (!priv->valid())
       return;
 
-   discard((*(priv->i))->node, xsink);
-   (*(priv->i))->node = 0;
+   AbstractQoreNode* n = h->priv->getValue(priv->i);
 
-   qhlist_t::iterator ni = priv->i;
-   priv->prev(h->priv->member_list);
+   size_t ni = priv->i;
+   priv->prev(*h->priv);
+   h->priv->erase(ni);
 
-   hm_hm_t::iterator i = h->priv->hm.find((*ni)->key.c_str());
-   assert(i != h->priv->hm.end());
-   h->priv->hm.erase(i);
-   h->priv->internDeleteKey(ni);
+   discard(n, xsink);
 }
 
 // deprecated
@@ -691,23 +662,21 @@ AbstractQoreNode** HashIterator::getValuePtr() const {
    if (!priv->valid())
       return 0;
 
-   return &((*(priv->i))->node);
+   return &h->priv->getValueRef(priv->i);
 }
 
 bool HashIterator::last() const {
    if (!priv->valid())
       return false;
 
-   qhlist_t::const_iterator ni = priv->i;
-   ++ni;
-   return ni == h->priv->member_list.end() ? true : false;
+   return h->priv->next(priv->i) == qore_hash_private::npos;
 }
 
 bool HashIterator::first() const {
    if (!priv->valid())
       return false;
 
-   return priv->i == h->priv->member_list.begin();
+   return h->priv->prev(priv->i) == qore_hash_private::npos;
 }
 
 bool HashIterator::empty() const {
@@ -757,48 +726,46 @@ ConstHashIterator::~ConstHashIterator() {
 }
 
 AbstractQoreNode* ConstHashIterator::getReferencedValue() const {
-   return !priv->valid() || !(*(priv->i))->node ? 0 : (*(priv->i))->node->refSelf();
+   return !priv->valid() || !h->priv->getValue(priv->i) ? 0 : h->priv->getValue(priv->i)->refSelf();
 }
 
 QoreString* ConstHashIterator::getKeyString() const {
-   return !priv->valid() ? 0 : new QoreString((*(priv->i))->key);
+   return !priv->valid() ? 0 : new QoreString(h->priv->getKey(priv->i));
 }
 
 bool ConstHashIterator::next() {
-   return h ? priv->next(h->priv->member_list) : false;
+   return h ? priv->next(*h->priv) : false;
 }
 
 bool ConstHashIterator::prev() {
-   return h ? priv->prev(h->priv->member_list) : false;
+   return h ? priv->prev(*h->priv) : false;
 }
 
 const char* ConstHashIterator::getKey() const {
    if (!priv->valid())
       return 0;
-   return (*(priv->i))->key.c_str();
+   return h->priv->getKey(priv->i).c_str();
 }
 
 const AbstractQoreNode* ConstHashIterator::getValue() const {
    if (!priv->valid())
       return 0;
 
-   return (*(priv->i))->node;
+   return h->priv->getValue(priv->i);
 }
 
 bool ConstHashIterator::last() const {
    if (!priv->valid())
       return false;
 
-   qhlist_t::const_iterator ni = priv->i;
-   ++ni;
-   return ni == h->priv->member_list.end() ? true : false;
+   return h->priv->next(priv->i) == qore_hash_private::npos;
 }
 
 bool ConstHashIterator::first() const {
    if (!priv->valid())
       return false;
 
-   return priv->i == h->priv->member_list.begin();
+   return h->priv->prev(priv->i) == qore_hash_private::npos;
 }
 
 bool ConstHashIterator::empty() const {
@@ -838,38 +805,38 @@ bool ReverseConstHashIterator::prev() {
    return ConstHashIterator::next();
 }
 
-hash_assignment_priv::hash_assignment_priv(qore_hash_private& n_h, const char* key, bool must_already_exist) : h(n_h), om(must_already_exist ? h.findMember(key) : h.findCreateMember(key)) {
+hash_assignment_priv::hash_assignment_priv(qore_hash_private& n_h, const char* key, bool must_already_exist) : h(n_h), pos(h.findValuePos(key, !must_already_exist)) {
 }
 
-hash_assignment_priv::hash_assignment_priv(QoreHashNode& n_h, const char* key, bool must_already_exist) : h(*n_h.priv), om(must_already_exist ? h.findMember(key) : h.findCreateMember(key)) {
+hash_assignment_priv::hash_assignment_priv(QoreHashNode& n_h, const char* key, bool must_already_exist) : h(*n_h.priv), pos(h.findValuePos(key, !must_already_exist)) {
 }
 
-hash_assignment_priv::hash_assignment_priv(QoreHashNode& n_h, const std::string& key, bool must_already_exist) : h(*n_h.priv), om(must_already_exist ? h.findMember(key.c_str()) : h.findCreateMember(key.c_str())) {
+hash_assignment_priv::hash_assignment_priv(QoreHashNode& n_h, const std::string& key, bool must_already_exist) : h(*n_h.priv), pos(h.findValuePos(key.c_str(), !must_already_exist)) {
 }
 
-hash_assignment_priv::hash_assignment_priv(ExceptionSink* xsink, QoreHashNode& n_h, const QoreString& key, bool must_already_exist) : h(*n_h.priv), om(0) {
+hash_assignment_priv::hash_assignment_priv(ExceptionSink* xsink, QoreHashNode& n_h, const QoreString& key, bool must_already_exist) : h(*n_h.priv), pos(qore_hash_private::npos) {
    TempEncodingHelper k(key, QCS_DEFAULT, xsink);
    if (*xsink)
       return;
 
-   om = must_already_exist ? h.findMember(k->getBuffer()) : h.findCreateMember(k->getBuffer());
+   pos = h.findValuePos(k->getBuffer(), !must_already_exist);
 }
 
-hash_assignment_priv::hash_assignment_priv(ExceptionSink* xsink, QoreHashNode& n_h, const QoreString* key, bool must_already_exist) : h(*n_h.priv), om(0) {
+hash_assignment_priv::hash_assignment_priv(ExceptionSink* xsink, QoreHashNode& n_h, const QoreString* key, bool must_already_exist) : h(*n_h.priv), pos(qore_hash_private::npos) {
    TempEncodingHelper k(key, QCS_DEFAULT, xsink);
    if (*xsink)
       return;
 
-   om = must_already_exist ? h.findMember(k->getBuffer()) : h.findCreateMember(k->getBuffer());
+   pos = h.findValuePos(k->getBuffer(), !must_already_exist);
 }
 
 AbstractQoreNode* hash_assignment_priv::swapImpl(AbstractQoreNode* v) {
-   assert(om);
+   assert(pos != qore_hash_private::npos);
    // before we can entirely get rid of QoreNothingNode, try to convert pointers to NOTHING to 0
    if (v == &Nothing)
       v = 0;
-   AbstractQoreNode* old = om->node;
-   om->node = v;
+   AbstractQoreNode* old = h.vals[pos];
+   h.vals[pos] = v;
 
    bool before = get_container_obj(old);
    bool after = get_container_obj(v);
@@ -893,7 +860,7 @@ void hash_assignment_priv::assign(AbstractQoreNode* v, ExceptionSink* xsink) {
 }
 
 AbstractQoreNode* hash_assignment_priv::getValueImpl() const {
-   return om->node;
+   return h.vals[pos];
 }
 
 HashAssignmentHelper::HashAssignmentHelper(QoreHashNode& h, const char* key, bool must_already_exist) : priv(new hash_assignment_priv(*h.priv, key, must_already_exist)) {
@@ -918,7 +885,7 @@ HashAssignmentHelper::HashAssignmentHelper(ExceptionSink* xsink, QoreHashNode& h
    priv = new hash_assignment_priv(*h.priv, k->getBuffer(), must_already_exist);
 }
 
-HashAssignmentHelper::HashAssignmentHelper(HashIterator &hi) : priv(new hash_assignment_priv(*hi.h->priv, *(hi.priv->i))) {
+HashAssignmentHelper::HashAssignmentHelper(HashIterator &hi) : priv(new hash_assignment_priv(*hi.h->priv, hi.h->priv->getValuePos(hi.priv->i))) {
 }
 
 HashAssignmentHelper::~HashAssignmentHelper() {
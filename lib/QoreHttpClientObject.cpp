@@ -41,18 +41,23 @@
 #include <qore/intern/QC_Socket.h>
 #include <qore/intern/QC_Queue.h>
 #include <qore/intern/QoreHttpClientObjectIntern.h>
+#include <qore/intern/QC_Compressor.h>
+#include <qore/intern/QoreLibIntern.h>
 
 #include <qore/intern/qore_socket_private.h>
 
 #include <string>
 #include <map>
 #include <set>
+#include <vector>
 
 #include <ctype.h>
 
 method_map_t method_map;
 strcase_set_t header_ignore;
 
+class qore_httpclient_pool;
+
 struct qore_httpclient_priv {
    my_socket_priv* msock;
 
@@ -64,7 +69,8 @@ struct qore_httpclient_priv {
    bool connected, 
       nodelay, 
       proxy_connected, // means that a CONNECT message has been processed and the connection is now made as if it were directly with the client
-      persistent;      // turns off implicit connections for the current connection only
+      persistent,      // turns off implicit connections for the current connection only
+      decompress_recv_callback; // decompress compressed message bodies before passing them to receive callbacks
    int default_port, max_redirects;
    std::string default_path;
    int timeout;
@@ -73,15 +79,19 @@ struct qore_httpclient_priv {
    int connect_timeout_ms;   
 
    method_map_t additional_methods_map;
+
+   // connection pool; only set in pooled mode
+   qore_httpclient_pool* pool;
   
    DLLLOCAL qore_httpclient_priv(my_socket_priv* ms) :
       msock(ms), http11(true), connection(HTTPCLIENT_DEFAULT_PORT),
       connected(false), nodelay(false), proxy_connected(false),
-      persistent(false),
+      persistent(false), decompress_recv_callback(false),
       default_port(HTTPCLIENT_DEFAULT_PORT), 
       max_redirects(HTTPCLIENT_DEFAULT_MAX_REDIRECTS),
       timeout(HTTPCLIENT_DEFAULT_TIMEOUT),
-      connect_timeout_ms(-1) {
+      connect_timeout_ms(-1),
+      pool(0) {
       assert(ms);
       // setup protocol map
       prot_map["http"] = make_protocol(80, false);
@@ -95,7 +105,27 @@ struct qore_httpclient_priv {
       default_headers["Accept-Encoding"] = "deflate,gzip,bzip2";
    }
 
-   DLLLOCAL ~qore_httpclient_priv() {
+   DLLLOCAL ~qore_httpclient_priv();
+
+   // copies the configuration of the given object to a pooled connection; disconnects if the server has changed
+   DLLLOCAL void setConfig(const qore_httpclient_priv& old) {
+      if (connected && (socketpath != old.socketpath || connection.ssl != old.connection.ssl || proxy_connection.ssl != old.proxy_connection.ssl))
+	 disconnect_unlocked();
+
+      http11 = old.http11;
+      prot_map = old.prot_map;
+      connection = old.connection;
+      proxy_connection = old.proxy_connection;
+      nodelay = old.nodelay;
+      default_port = old.default_port;
+      max_redirects = old.max_redirects;
+      default_path = old.default_path;
+      timeout = old.timeout;
+      socketpath = old.socketpath;
+      default_headers = old.default_headers;
+      connect_timeout_ms = old.connect_timeout_ms;
+      additional_methods_map = old.additional_methods_map;
+      decompress_recv_callback = old.decompress_recv_callback;
    }
 
    DLLLOCAL void setSocketPathIntern(const con_info& con) {
@@ -173,6 +203,11 @@ struct qore_httpclient_priv {
    }
 
    DLLLOCAL void setPersistent(ExceptionSink* xsink) {
+      if (pool) {
+	 xsink->raiseException("PERSISTENCE-ERROR", "HTTPClient::setPersistent() cannot be used in pooled mode, where each request uses a connection from the connection pool");
+	 return;
+      }
+
       AutoLocker al(msock->m);
       
       if (!connected) {
@@ -344,6 +379,16 @@ struct qore_httpclient_priv {
 
    DLLLOCAL QoreHashNode* send_internal(ExceptionSink* xsink, const char* mname, const char* meth, const char* mpath, const QoreHashNode* headers, const void* data, unsigned size, const ResolvedCallReferenceNode* send_callback, bool getbody, QoreHashNode* info, int timeout_ms, const ResolvedCallReferenceNode* recv_callback = 0, QoreObject* obj = 0);
 
+   // sends the request on a connection checked out from the pool
+   DLLLOCAL QoreHashNode* send_pooled(ExceptionSink* xsink, const char* mname, const char* meth, const char* mpath, const QoreHashNode* headers, const void* data, unsigned size, const ResolvedCallReferenceNode* send_callback, bool getbody, QoreHashNode* info, int timeout_ms, const ResolvedCallReferenceNode* recv_callback, QoreObject* obj);
+
+   // establishes a pooled connection to the server; returns 0 for OK, -1 for error
+   DLLLOCAL int connect_pooled(ExceptionSink* xsink);
+
+   // reads the message body and decompresses it as it is received; the decompressed data is passed to the receive
+   // callback if there is one, otherwise it is returned as a string in body; returns 0 for OK, -1 for error
+   DLLLOCAL int readDecompressedBody(ExceptionSink* xsink, const char* mname, qore_compression_alg_e alg, bool chunked, qore_offset_t len, int timeout_ms, const ResolvedCallReferenceNode* recv_callback, QoreObject* obj, QoreHashNode& ans, AbstractQoreNode*& body);
+
    DLLLOCAL void addProxyAuthorization(const QoreHashNode* headers, QoreHashNode& h, ExceptionSink* xsink) {
       if (proxy_connection.username.empty())
 	 return;
@@ -373,6 +418,355 @@ struct qore_httpclient_priv {
    }
 };
 
+// a connection in an HTTPClient connection pool
+struct qore_httpclient_conn {
+   my_socket_priv* msock;
+   qore_httpclient_priv* hc;
+   // the time the connection was last returned to the pool in microseconds
+   int64 last_used;
+
+   DLLLOCAL qore_httpclient_conn() : msock(new my_socket_priv), hc(new qore_httpclient_priv(msock)), last_used(0) {
+   }
+
+   DLLLOCAL ~qore_httpclient_conn() {
+      delete hc;
+      delete msock;
+   }
+
+   // copies the configuration of the HTTPClient object to the connection; the object's lock must be held
+   DLLLOCAL void setConfig(const qore_httpclient_priv& old, ExceptionSink* xsink) {
+      hc->setConfig(old);
+
+      const my_socket_priv& ms = *old.msock;
+      msock->socket->setEncoding(ms.socket->getEncoding());
+
+      Queue* q = ms.socket->getQueue();
+      if (q != msock->socket->getQueue()) {
+	 if (q)
+	    q->ref();
+	 msock->socket->setEventQueue(q, xsink);
+      }
+
+      // copy the warning queue and its thresholds
+      const qore_socket_private* os = qore_socket_private::get(*ms.socket);
+      qore_socket_private* ns = qore_socket_private::get(*msock->socket);
+      if (!os->warn_queue)
+	 ns->clearWarningQueue(xsink);
+      else if (os->warn_queue != ns->warn_queue || os->callback_arg != ns->callback_arg || os->tl_warning_us != ns->tl_warning_us
+	       || os->tp_warning_bs != ns->tp_warning_bs || os->tp_us_min != ns->tp_us_min) {
+	 os->warn_queue->ref();
+	 ns->setWarningQueue(xsink, os->tl_warning_us / 1000, (int64)os->tp_warning_bs, os->warn_queue,
+			     os->callback_arg ? os->callback_arg->refSelf() : 0, os->tp_us_min / 1000);
+      }
+
+      if (ms.cert != msock->cert) {
+	 if (msock->cert)
+	    msock->cert->deref();
+	 msock->cert = ms.cert;
+	 if (ms.cert)
+	    ms.cert->ref();
+      }
+      if (ms.pk != msock->pk) {
+	 if (msock->pk)
+	    msock->pk->deref();
+	 msock->pk = ms.pk;
+	 if (ms.pk)
+	    ms.pk->ref();
+      }
+   }
+
+   // must be called before the connection is deleted
+   DLLLOCAL void cleanup(ExceptionSink* xsink) {
+      msock->socket->cleanup(xsink);
+   }
+};
+
+// a pool of keep-alive connections used by an HTTPClient object in pooled mode
+/* each request checks out a connection for its duration; threads waiting for a connection when the pool is at its
+   maximum size are served in the order they arrived, and connections idle for longer than the idle timeout are closed
+*/
+class qore_httpclient_pool {
+protected:
+   typedef std::vector<qore_httpclient_conn*> conn_vec_t;
+
+   mutable QoreThreadLock l;
+   QoreCondition cond;
+
+   // idle connections; the most recently used connection is at the end
+   conn_vec_t idle;
+
+   // the maximum number of connections
+   int max;
+   // the idle timeout in milliseconds; 0 means no timeout
+   int idle_timeout_ms;
+   // the current number of connections, both idle and in use
+   int total;
+   // the number of threads waiting for a connection
+   int waiting;
+
+   // waiting threads are served in ticket order
+   int64 ticket_next, ticket_serve;
+   // tickets of waiting threads that timed out
+   std::set<int64> cancelled;
+
+   // statistics
+   int64 requests, waits, wait_us, created, evicted, timeouts;
+
+   // set by clear(); connections returned after this are deleted instead of being added to the idle list
+   bool closed;
+
+   // removes connections that have been idle for longer than the idle timeout; the lock must be held
+   DLLLOCAL void evictIntern(conn_vec_t& expired) {
+      if (!idle_timeout_ms || idle.empty())
+	 return;
+
+      int64 cutoff = q_clock_getmicros() - (int64)idle_timeout_ms * 1000;
+      conn_vec_t::iterator i = idle.begin();
+      while (i != idle.end() && (*i)->last_used < cutoff)
+	 ++i;
+      if (i == idle.begin())
+	 return;
+
+      expired.insert(expired.end(), idle.begin(), i);
+      idle.erase(idle.begin(), i);
+      total -= expired.size();
+      evicted += expired.size();
+   }
+
+   // lets the next waiting thread proceed; the lock must be held
+   DLLLOCAL void nextTicket() {
+      ++ticket_serve;
+      while (!cancelled.empty() && cancelled.erase(ticket_serve))
+	 ++ticket_serve;
+   }
+
+   // returns a connection; the lock must be held and a connection must be available
+   DLLLOCAL qore_httpclient_conn* takeIntern() {
+      if (!idle.empty()) {
+	 qore_httpclient_conn* c = idle.back();
+	 idle.pop_back();
+	 return c;
+      }
+      assert(total < max);
+      ++total;
+      ++created;
+      return new qore_httpclient_conn;
+   }
+
+   DLLLOCAL bool availableIntern() const {
+      return !idle.empty() || total < max;
+   }
+
+   // deletes the connections given; must be called without the lock
+   DLLLOCAL static void del(conn_vec_t& cv, ExceptionSink* xsink) {
+      for (conn_vec_t::iterator i = cv.begin(), e = cv.end(); i != e; ++i) {
+	 (*i)->cleanup(xsink);
+	 delete *i;
+      }
+      cv.clear();
+   }
+
+public:
+   DLLLOCAL qore_httpclient_pool(int n_max, int n_idle_timeout_ms) : max(n_max), idle_timeout_ms(n_idle_timeout_ms), total(0), waiting(0),
+                                                                     ticket_next(0), ticket_serve(0),
+                                                                     requests(0), waits(0), wait_us(0), created(0), evicted(0), timeouts(0), closed(false) {
+      assert(max > 0);
+   }
+
+   // all connections must have been returned and the pool closed with clear() before the pool is deleted
+   DLLLOCAL ~qore_httpclient_pool() {
+      assert(idle.empty());
+      assert(!total);
+   }
+
+   // returns a connection for a request, waiting for one if the pool is at its maximum size; returns 0 if a timeout occurred
+   DLLLOCAL qore_httpclient_conn* checkout(int timeout_ms, ExceptionSink* xsink) {
+      conn_vec_t expired;
+      qore_httpclient_conn* c = 0;
+      bool is_closed = false;
+      {
+	 AutoLocker al(l);
+	 if (closed) {
+	    xsink->raiseException("HTTP-CLIENT-POOL-CLOSED", "the connection pool has been closed because the HTTPClient object is being deleted");
+	    return 0;
+	 }
+	 ++requests;
+	 evictIntern(expired);
+
+	 if (ticket_next == ticket_serve && availableIntern())
+	    c = takeIntern();
+	 else {
+	    // wait in line for a connection
+	    int64 ticket = ticket_next++;
+	    ++waits;
+	    ++waiting;
+	    int64 start = q_clock_getmicros();
+	    bool timed_out = false;
+	    while (ticket != ticket_serve || !availableIntern()) {
+	       if (closed) {
+		  is_closed = true;
+		  break;
+	       }
+	       if (timeout_ms <= 0) {
+		  cond.wait(&l);
+		  continue;
+	       }
+	       int64 remaining = (int64)timeout_ms - (q_clock_getmicros() - start) / 1000;
+	       if (remaining <= 0 || cond.wait(&l, (int)remaining)) {
+		  // a connection may have been returned at the same time
+		  if (ticket != ticket_serve || !availableIntern())
+		     timed_out = true;
+		  break;
+	       }
+	    }
+	    --waiting;
+	    wait_us += q_clock_getmicros() - start;
+
+	    if (is_closed) {
+	       // the pool will not be used again, so the ticket does not need to be released
+	    }
+	    else if (timed_out) {
+	       ++timeouts;
+	       if (ticket == ticket_serve) {
+		  nextTicket();
+		  cond.broadcast();
+	       }
+	       else
+		  cancelled.insert(ticket);
+	    }
+	    else {
+	       c = takeIntern();
+	       nextTicket();
+	       // the next thread in line may be able to proceed as well
+	       if (waiting)
+		  cond.broadcast();
+	    }
+	 }
+      }
+
+      del(expired, xsink);
+
+      if (is_closed)
+	 xsink->raiseException("HTTP-CLIENT-POOL-CLOSED", "the connection pool was closed while waiting for a connection because the HTTPClient object is being deleted");
+      else if (!c)
+	 xsink->raiseException("HTTP-CLIENT-POOL-TIMEOUT", "timeout waiting %d ms for a connection from the connection pool (all %d connections are in use)", timeout_ms, max);
+      return c;
+   }
+
+   // returns a connection to the pool; if the pool has been closed, the connection is deleted
+   DLLLOCAL void checkin(qore_httpclient_conn* c, ExceptionSink* xsink) {
+      conn_vec_t expired;
+      {
+	 AutoLocker al(l);
+	 if (closed) {
+	    --total;
+	    expired.push_back(c);
+	 }
+	 else {
+	    c->last_used = q_clock_getmicros();
+	    idle.push_back(c);
+	    evictIntern(expired);
+	    if (waiting)
+	       cond.broadcast();
+	 }
+      }
+      del(expired, xsink);
+   }
+
+   // closes the connections of all idle pooled connections
+   DLLLOCAL void disconnect() {
+      AutoLocker al(l);
+      for (conn_vec_t::iterator i = idle.begin(), e = idle.end(); i != e; ++i) {
+	 AutoLocker cal((*i)->msock->m);
+	 (*i)->hc->disconnect_unlocked();
+      }
+   }
+
+   // closes the pool and deletes all idle connections; connections still in use are deleted when they are returned
+   // with checkin(), and threads waiting for a connection get an exception
+   DLLLOCAL void clear(ExceptionSink* xsink) {
+      conn_vec_t cv;
+      {
+	 AutoLocker al(l);
+	 closed = true;
+	 cv.swap(idle);
+	 total -= cv.size();
+	 if (waiting)
+	    cond.broadcast();
+      }
+      del(cv, xsink);
+   }
+
+   // returns true if any pooled connection is in use or connected
+   DLLLOCAL bool isConnected() const {
+      AutoLocker al(l);
+      if (total > (int)idle.size())
+	 return true;
+      for (conn_vec_t::const_iterator i = idle.begin(), e = idle.end(); i != e; ++i) {
+	 if ((*i)->hc->connected)
+	    return true;
+      }
+      return false;
+   }
+
+   // returns a hash of pool statistics
+   DLLLOCAL QoreHashNode* getInfo() const {
+      QoreHashNode* h = new QoreHashNode;
+      AutoLocker al(l);
+      h->setKeyValue("max", new QoreBigIntNode(max), 0);
+      h->setKeyValue("idle_timeout", new QoreBigIntNode(idle_timeout_ms), 0);
+      h->setKeyValue("connections", new QoreBigIntNode(total), 0);
+      h->setKeyValue("idle", new QoreBigIntNode(idle.size()), 0);
+      h->setKeyValue("in_use", new QoreBigIntNode(total - idle.size()), 0);
+      h->setKeyValue("waiting", new QoreBigIntNode(waiting), 0);
+      h->setKeyValue("requests", new QoreBigIntNode(requests), 0);
+      h->setKeyValue("waits", new QoreBigIntNode(waits), 0);
+      h->setKeyValue("wait_us", new QoreBigIntNode(wait_us), 0);
+      h->setKeyValue("timeouts", new QoreBigIntNode(timeouts), 0);
+      h->setKeyValue("created", new QoreBigIntNode(created), 0);
+      h->setKeyValue("evicted", new QoreBigIntNode(evicted), 0);
+      return h;
+   }
+};
+
+qore_httpclient_priv::~qore_httpclient_priv() {
+   delete pool;
+}
+
+QoreHashNode* qore_httpclient_priv::send_pooled(ExceptionSink* xsink, const char* mname, const char* meth, const char* mpath, const QoreHashNode* headers, const void* data, unsigned size, const ResolvedCallReferenceNode* send_callback, bool getbody, QoreHashNode* info, int timeout_ms, const ResolvedCallReferenceNode* recv_callback, QoreObject* obj) {
+   qore_httpclient_conn* c = pool->checkout(timeout_ms ? timeout_ms : timeout, xsink);
+   if (!c)
+      return 0;
+
+   {
+      AutoLocker al(msock->m);
+      c->setConfig(*this, xsink);
+   }
+
+   QoreHashNode* rv = *xsink ? 0 : c->hc->send_internal(xsink, mname, meth, mpath, headers, data, size, send_callback, getbody, info, timeout_ms, recv_callback, obj);
+   pool->checkin(c, xsink);
+   return rv;
+}
+
+int qore_httpclient_priv::connect_pooled(ExceptionSink* xsink) {
+   qore_httpclient_conn* c = pool->checkout(timeout, xsink);
+   if (!c)
+      return -1;
+
+   {
+      AutoLocker al(msock->m);
+      c->setConfig(*this, xsink);
+   }
+
+   int rc = -1;
+   if (!*xsink) {
+      AutoLocker al(c->msock->m);
+      rc = c->hc->connected ? 0 : c->hc->connect_unlocked(xsink);
+   }
+   pool->checkin(c, xsink);
+   return rc;
+}
+
 // static initialization
 void QoreHttpClientObject::static_init() {
    // setup static members of QoreHttpClientObject class
@@ -525,6 +919,24 @@ int QoreHttpClientObject::setOptions(const QoreHashNode* opts, ExceptionSink* xs
 
    http_priv->connect_timeout_ms = getMsMinusOneInt(opts->getKeyValue("connect_timeout"));
 
+   n = opts->getKeyValue("decompress_recv_callback");
+   if (n)
+      http_priv->decompress_recv_callback = n->getAsBool();
+
+   // pooled mode with the given maximum number of connections
+   n = opts->getKeyValue("pool_size");
+   if (n) {
+      int max = n->getAsInt();
+      if (max < 0) {
+	 xsink->raiseException("HTTP-CLIENT-OPTION-ERROR", "the value of the pool_size option must not be negative; got: %d", max);
+	 return -1;
+      }
+      if (max && !http_priv->pool) {
+	 n = opts->getKeyValue("pool_idle_timeout");
+	 http_priv->pool = new qore_httpclient_pool(max, n ? getMsZeroInt(n) : HTTPCLIENT_DEFAULT_POOL_IDLE_TIMEOUT);
+      }
+   }
+
    if (http_priv->connection.path.empty())
       http_priv->connection.path = http_priv->default_path.empty() ? "/" : http_priv->default_path;
 
@@ -641,11 +1053,17 @@ bool QoreHttpClientObject::isProxySecure() const {
 }
 
 int QoreHttpClientObject::connect(ExceptionSink* xsink) {
+   if (http_priv->pool)
+      return http_priv->connect_pooled(xsink);
+
    SafeLocker sl(priv->m);
    return http_priv->connect_unlocked(xsink);
 }
 
 void QoreHttpClientObject::disconnect() {
+   if (http_priv->pool)
+      http_priv->pool->disconnect();
+
    SafeLocker sl(priv->m);
    http_priv->disconnect_unlocked();
 }
@@ -795,9 +1213,68 @@ static const char* get_string_header(ExceptionSink* xsink, QoreHashNode& h, cons
    return str && !str->empty() ? str->getBuffer() : 0;
 }
 
+// passes decompressed message body data to a receive callback in blocks as it is produced
+class HttpRecvCallbackSink : public AbstractCompressionSink {
+protected:
+   qore_socket_private* sock;
+   const char* mname;
+   const ResolvedCallReferenceNode* callback;
+   QoreThreadLock* l;
+   const QoreEncoding* enc;
+   bool chunked;
+
+public:
+   DLLLOCAL HttpRecvCallbackSink(qore_socket_private* n_sock, const char* n_mname, const ResolvedCallReferenceNode* n_callback, QoreThreadLock* n_l, const QoreEncoding* n_enc, bool n_chunked) : sock(n_sock), mname(n_mname), callback(n_callback), l(n_l), enc(n_enc), chunked(n_chunked) {
+   }
+
+   DLLLOCAL virtual int write(const void* buf, size_t len, ExceptionSink* xsink) {
+      QoreStringNodeHolder str(new QoreStringNode((const char*)buf, len, enc));
+      return sock->runDataCallback(xsink, mname, *callback, l, *str, chunked);
+   }
+};
+
+int qore_httpclient_priv::readDecompressedBody(ExceptionSink* xsink, const char* mname, qore_compression_alg_e alg, bool chunked, qore_offset_t len, int timeout_ms, const ResolvedCallReferenceNode* recv_callback, QoreObject* obj, QoreHashNode& ans, AbstractQoreNode*& body) {
+   ReferenceHolder<QoreCompressionStream> zs(new QoreCompressionStream(alg, false, -1, xsink), xsink);
+   if (*xsink)
+      return -1;
+
+   qore_socket_private* sock = msock->socket->priv;
+   const QoreEncoding* enc = msock->socket->getEncoding();
+
+   // only the decompressed data is held in memory, or none at all if there is a receive callback
+   QoreStringNodeHolder str(new QoreStringNode(enc));
+   StringCompressionSink ssink(**str);
+   HttpRecvCallbackSink csink(sock, mname, recv_callback, &msock->m, enc, chunked);
+   AbstractCompressionSink& out = recv_callback ? (AbstractCompressionSink&)csink : (AbstractCompressionSink&)ssink;
+   DecompressionSink dsink(**zs, out);
+
+   ReferenceHolder<QoreHashNode> footers(sock->readHttpBody(dsink, chunked, len, timeout_ms, xsink, QORE_SOURCE_HTTPCLIENT), xsink);
+   if (*xsink)
+      return -1;
+
+   // an empty body is not an error
+   if (zs->getTotalIn() && dsink.finish(xsink))
+      return -1;
+
+   if (recv_callback)
+      return sock->runHeaderCallback(xsink, mname, *recv_callback, &msock->m, footers && !footers->empty() ? *footers : 0, false, obj);
+
+   if (footers) {
+      ans.merge(*footers, xsink);
+      if (*xsink)
+         return -1;
+   }
+   body = str.release();
+   return 0;
+}
+
 QoreHashNode* qore_httpclient_priv::send_internal(ExceptionSink* xsink, const char* mname, const char* meth, const char* mpath, const QoreHashNode* headers, const void* data, unsigned size, const ResolvedCallReferenceNode* send_callback, bool getbody, QoreHashNode* info, int timeout_ms, const ResolvedCallReferenceNode* recv_callback, QoreObject* obj) {
    assert(!(data && send_callback));
 
+   // in pooled mode the request is sent on a pooled connection
+   if (pool)
+      return send_pooled(xsink, mname, meth, mpath, headers, data, size, send_callback, getbody, info, timeout_ms, recv_callback, obj);
+
    // check if method is valid
    method_map_t::const_iterator i = method_map.find(meth);
    if (i == method_map.end()) {
@@ -1133,7 +1610,9 @@ QoreHashNode* qore_httpclient_priv::send_internal(ExceptionSink* xsink, const ch
     */
    //printd(5, "qore_httpclient_priv::send_internal() this: %p bodyp: %d code: %d\n", this, bodyp, code);
 
-   qore_uncompress_to_string_t dec = 0;
+   // the algorithm for decompressing the message body as it is received
+   qore_compression_alg_e alg = QCA_ZLIB;
+   bool decompress = false;
 
    // code >= 300 && < 400 is already handled above
    if (bodyp && (code < 100 || code >= 200) && code != 204) {
@@ -1150,14 +1629,17 @@ QoreHashNode* qore_httpclient_priv::send_internal(ExceptionSink* xsink, const ch
 	    msock->socket->setEncoding(QEM.findCreate(content_encoding));
 	    content_encoding = 0;
 	 }
-	 else if (!recv_callback) {
-	    // only decode message bodies automatically if there is no receive callback
+	 else if (!recv_callback || decompress_recv_callback) {
+	    // only decode message bodies automatically if there is no receive callback unless requested
+	    decompress = true;
 	    if (!strcasecmp(content_encoding, "deflate") || !strcasecmp(content_encoding, "x-deflate"))
-	       dec = qore_inflate_to_string;
+	       alg = QCA_ZLIB;
 	    else if (!strcasecmp(content_encoding, "gzip") || !strcasecmp(content_encoding, "x-gzip"))
-	       dec = qore_gunzip_to_string;
+	       alg = QCA_GZIP;
 	    else if (!strcasecmp(content_encoding, "bzip2") || !strcasecmp(content_encoding, "x-bzip2"))
-	       dec = qore_bunzip2_to_string;
+	       alg = QCA_BZIP2;
+	    else
+	       decompress = false;
 	 }
       }
 
@@ -1178,7 +1660,30 @@ QoreHashNode* qore_httpclient_priv::send_internal(ExceptionSink* xsink, const ch
       if (cl && cb_queue)
 	 do_content_length_event(cb_queue, msock->socket->getObjectIDForEvents(), len);
 
-      if (te && !strcasecmp(te, "chunked")) { // check for chunked response body
+      bool chunked = te && !strcasecmp(te, "chunked");
+
+      if (decompress) {
+	 // compressed message bodies are decompressed as they are received
+	 if (chunked || getbody || len) {
+	    if (chunked && cb_queue)
+	       do_event(cb_queue, msock->socket->getObjectIDForEvents(), QORE_EVENT_HTTP_CHUNKED_START);
+	    // without a Content-Length header, the body is read until the server closes the connection
+	    int rc = readDecompressedBody(xsink, mname, alg, chunked, cl ? len : -1, timeout_ms, recv_callback, obj, **ans, body);
+	    if (chunked && cb_queue)
+	       do_event(cb_queue, msock->socket->getObjectIDForEvents(), QORE_EVENT_HTTP_CHUNKED_END);
+	    if (rc) {
+	       disconnect_unlocked();
+	       return 0;
+	    }
+
+	    if (chunked && info) {
+	       info->setKeyValue("chunked", &True, xsink);
+	       if (*xsink)
+		  return 0;
+	    }
+	 }
+      }
+      else if (chunked) { // check for chunked response body
 	 if (cb_queue)
 	    do_event(cb_queue, msock->socket->getObjectIDForEvents(), QORE_EVENT_HTTP_CHUNKED_START);
 	 ReferenceHolder<QoreHashNode> nah(xsink);
@@ -1247,23 +1752,13 @@ QoreHashNode* qore_httpclient_priv::send_internal(ExceptionSink* xsink, const ch
 
    sl.unlock();
 
-   // for content-encoding processing we can run unlocked
-
-   // add body to result hash and process content encoding if necessary
+   // add body to result hash; compressed bodies have already been decompressed as they were received
    if (body) {
-      if (content_encoding) {
-	 if (!dec) {
-	    if (!recv_callback) {
-	       xsink->raiseException("HTTP-CLIENT-RECEIVE-ERROR", "don't know how to handle content-encoding '%s'", content_encoding);
-	       ans = 0;
-	    }
-	 }
-	 else {
-	    BinaryNode* bobj = reinterpret_cast<BinaryNode*>(body);
-	    QoreStringNode* str = dec(bobj, msock->socket->getEncoding(), xsink);
-	    bobj->deref();
-	    body = str;
-	 }
+      if (content_encoding && !decompress && !recv_callback) {
+	 xsink->raiseException("HTTP-CLIENT-RECEIVE-ERROR", "don't know how to handle content-encoding '%s'", content_encoding);
+	 body->deref(xsink);
+	 body = 0;
+	 ans = 0;
       }
 
       if (body) {
@@ -1353,6 +1848,9 @@ void QoreHttpClientObject::setEventQueue(Queue *cbq, ExceptionSink* xsink) {
 }
 
 void QoreHttpClientObject::cleanup(ExceptionSink* xsink) {
+   if (http_priv->pool)
+      http_priv->pool->clear(xsink);
+
    AutoLocker al(priv->m);
    priv->socket->cleanup(xsink);
 }
@@ -1373,7 +1871,17 @@ bool QoreHttpClientObject::getNoDelay() const {
    return http_priv->getNoDelay();
 }
 
+void QoreHttpClientObject::setDecompressRecvCallback(bool dec) {
+   http_priv->decompress_recv_callback = dec;
+}
+
+bool QoreHttpClientObject::getDecompressRecvCallback() const {
+   return http_priv->decompress_recv_callback;
+}
+
 bool QoreHttpClientObject::isConnected() const {
+   if (http_priv->pool)
+      return http_priv->pool->isConnected();
    return http_priv->connected;
 }
 
@@ -1409,7 +1917,10 @@ void QoreHttpClientObject::setWarningQueue(ExceptionSink* xsink, int64 warning_m
    
 QoreHashNode* QoreHttpClientObject::getUsageInfo() const {
    AutoLocker al(priv->m);
-   return priv->socket->getUsageInfo();
+   QoreHashNode* h = priv->socket->getUsageInfo();
+   if (http_priv->pool)
+      h->setKeyValue("pool", http_priv->pool->getInfo(), 0);
+   return h;
 }
 
 void QoreHttpClientObject::clearStats() {
@@ -35,6 +35,7 @@
 #include <qore/intern/QoreObjectIntern.h>
 #include <qore/intern/qore_qd_private.h>
 #include <qore/intern/ql_crypto.h>
+#include <qore/intern/QoreCodec.h>
 
 #include <string.h>
 #ifdef HAVE_PWD_H
@@ -807,22 +808,15 @@ static void concatASCII(QoreString &str, unsigned char c) {
       str.sprintf(" ('%c')", c);
 }
 
-static char getBase64Value(const char* buf, qore_size_t &offset, bool end_ok, ExceptionSink* xsink) {
-   while (buf[offset] == '\n' || buf[offset] == '\r')
+static char getBase64Value(const char* buf, qore_size_t len, qore_size_t &offset, bool end_ok, ExceptionSink* xsink) {
+   while (offset < len && (buf[offset] == '\n' || buf[offset] == '\r'))
       ++offset;
 
-   char c = buf[offset];
+   char c = offset < len ? buf[offset] : '\0';
 
-   if (c >= 'A' && c <= 'Z')
-      return c - 'A';
-   if (c >= 'a' && c <= 'z')
-      return c - 'a' + 26;
-   if (c >= '0' && c <= '9')
-      return c - '0' + 52;
-   if (c == '+')
-      return 62;
-   if (c == '/')
-      return 63;
+   signed char v = q_base64_dec[(unsigned char)c];
+   if (v >= 0)
+      return v;
 
    if (!c) {
       if (!end_ok)
@@ -842,24 +836,35 @@ BinaryNode* parseBase64(const char* buf, int len, ExceptionSink* xsink) {
    if (!len)
       return new BinaryNode;
 
-   char* binbuf = (char* )malloc(sizeof(char) * (len + 3));
-   int blen = 0;
+   // the decoded data is at most 3 bytes for every 4 characters
+   char* binbuf = (char* )malloc(sizeof(char) * ((len / 4) * 3 + 3 + QORE_BASE64_DECODE_EXTRA));
+   qore_size_t blen = 0;
 
    qore_size_t pos = 0;
    while (pos < (qore_size_t)len) {
+      // skip line breaks and decode complete groups of valid characters in bulk
+      while (pos < (qore_size_t)len && (buf[pos] == '\n' || buf[pos] == '\r'))
+         ++pos;
+      qore_size_t used;
+      blen += q_base64_decode((unsigned char*)binbuf + blen, buf + pos, len - pos, used);
+      pos += used;
+      // padding, line breaks within a group, the end of the data and errors are handled below one group at a time
+      if (pos >= (qore_size_t)len)
+         break;
+
       // add first 6 bits
-      char b = getBase64Value(buf, pos, true, xsink);
+      char b = getBase64Value(buf, len, pos, true, xsink);
       if (xsink->isEvent()) {
          free(binbuf);
          return 0;
       }
       // if we've reached the end of the string here, then exit the loop
-      if (!buf[pos])
+      if (pos >= (qore_size_t)len || !buf[pos])
 	 break;
 
       // get second 6 bits
       ++pos;
-      char c = getBase64Value(buf, pos, false, xsink);
+      char c = getBase64Value(buf, len, pos, false, xsink);
       if (xsink->isEvent()) {
          free(binbuf);
          return 0;
@@ -869,14 +874,14 @@ BinaryNode* parseBase64(const char* buf, int len, ExceptionSink* xsink) {
 
       // check special cases
       ++pos;
-      if (buf[pos] == '=')
+      if (pos < (qore_size_t)len && buf[pos] == '=')
          break;
 
       // low 4 bits from 2nd char become high 4 bits of next value
       b = (c & 15) << 4;
 
       // get third 6 bits
-      c = getBase64Value(buf, pos, false, xsink);
+      c = getBase64Value(buf, len, pos, false, xsink);
       if (xsink->isEvent()) {
          free(binbuf);
          return 0;
@@ -886,14 +891,14 @@ BinaryNode* parseBase64(const char* buf, int len, ExceptionSink* xsink) {
 
       // check special cases
       ++pos;
-      if (buf[pos] == '=')
+      if (pos < (qore_size_t)len && buf[pos] == '=')
          break;
 
       // low 2 bits from 3rd char become high 2 bits of next value
       b = (c & 3) << 6;
 
       // get fourth 6 bits
-      c = getBase64Value(buf, pos, false, xsink);
+      c = getBase64Value(buf, len, pos, false, xsink);
       if (xsink->isEvent()) {
          free(binbuf);
          return 0;
@@ -927,23 +932,13 @@ BinaryNode* parseHex(const char* buf, int len, ExceptionSink* xsink) {
    }
 
    char* binbuf = (char* )malloc(sizeof(char) * (len / 2));
-   int blen = 0;
-
-   const char* end = buf + len;
-   while (buf < end) {
-      int b = get_nibble(*buf, xsink);
-      if (b < 0) {
-	 free(binbuf);
-	 return 0;
-      }
-      buf++;
-      int l = get_nibble(*buf, xsink);
-      if (l < 0) {
-	 free(binbuf);
-	 return 0;
-      }
-      buf++;
-      binbuf[blen++] = b << 4 | l;
+   qore_size_t blen = q_hex_decode((unsigned char*)binbuf, buf, len);
+   if (blen < (qore_size_t)(len / 2)) {
+      // raise an exception for the invalid digit
+      if (get_nibble(buf[blen * 2], xsink) >= 0)
+	 get_nibble(buf[blen * 2 + 1], xsink);
+      free(binbuf);
+      return 0;
    }
    return new BinaryNode(binbuf, blen);
 }
@@ -965,33 +960,15 @@ BinaryNode* parseHex(const char* buf, int len) {
    if (!buf || !(*buf))
       return new BinaryNode();
 
+   // the parser guarantees an even number of digits
    char* binbuf = (char* )malloc(sizeof(char) * (len / 2));
-   int blen = 0;
-
-   const char* end = buf + len;
-   while (buf < end) {
-      int b = parse_get_nibble(*buf);
-      if (b < 0) {
-	 free(binbuf);
-	 return 0;
-      }
-      buf++;
-#if 0
-      // this can never happen; the parser guarantees an even number of digits
-      if (!(*buf)) {
-	 free(binbuf);
-	 parseError("PARSE-HEX-ERROR", "cannot parse an odd number of hex digits (%d digit%s)", len, len == 1 ? "" : "s");
-	 return 0;
-      }
-#endif
-
-      int l = parse_get_nibble(*buf);
-      if (l < 0) {
-	 free(binbuf);
-	 return 0;
-      }
-      buf++;
-      binbuf[blen++] = b << 4 | l;
+   qore_size_t blen = q_hex_decode((unsigned char*)binbuf, buf, len);
+   if (blen < (qore_size_t)(len / 2)) {
+      // raise a parse exception for the invalid digit
+      if (parse_get_nibble(buf[blen * 2]) >= 0)
+	 parse_get_nibble(buf[blen * 2 + 1]);
+      free(binbuf);
+      return 0;
    }
    return new BinaryNode(binbuf, blen);
 }
@@ -46,6 +46,7 @@
 
 // include files for default object classes
 #include <qore/intern/QC_Socket.h>
+#include <qore/intern/QC_SocketPoller.h>
 #include <qore/intern/QC_SSLCertificate.h>
 #include <qore/intern/QC_SSLPrivateKey.h>
 #include <qore/intern/QC_Program.h>
@@ -57,6 +58,9 @@
 #include <qore/intern/QC_TermIOS.h>
 #include <qore/intern/QC_TimeZone.h>
 #include <qore/intern/QC_TreeMap.h>
+#include <qore/intern/QC_ColumnSet.h>
+#include <qore/intern/QC_Compressor.h>
+#include <qore/intern/QC_Digest.h>
 
 #include <qore/intern/QC_Datasource.h>
 #include <qore/intern/QC_DatasourcePool.h>
@@ -762,12 +766,15 @@ StaticSystemNamespace::StaticSystemNamespace() : RootQoreNamespace(new qore_root
    qns.addSystemClass(initTimeZoneClass(qns));
    qns.addSystemClass(initSSLCertificateClass(qns));
    qns.addSystemClass(initSSLPrivateKeyClass(qns));
-   qns.addSystemClass(initSocketClass(qns));
-   qns.addSystemClass(initProgramClass(qns));
-
+   // the file classes must be initialized before the Socket class, which takes ReadOnlyFile arguments
    qns.addSystemClass(initTermIOSClass(qns));
    qns.addSystemClass(initReadOnlyFileClass(qns));
    qns.addSystemClass(initFileClass(qns));
+
+   qns.addSystemClass(initSocketClass(qns));
+   qns.addSystemClass(initSocketPollerClass(qns));
+   qns.addSystemClass(initProgramClass(qns));
+
    qns.addSystemClass(initDirClass(qns));
    qns.addSystemClass(initGetOptClass(qns));
    qns.addSystemClass(initFtpClientClass(qns));
@@ -802,6 +809,11 @@ StaticSystemNamespace::StaticSystemNamespace() : RootQoreNamespace(new qore_root
    qns.addSystemClass(initSingleValueIteratorClass(qns));
    qns.addSystemClass(initRangeIteratorClass(qns));
    qns.addSystemClass(initTreeMapClass(qns));
+   qns.addSystemClass(initColumnSetClass(qns));
+   qns.addSystemClass(initColumnSetIteratorClass(qns));
+   qns.addSystemClass(initCompressorClass(qns));
+   qns.addSystemClass(initDecompressorClass(qns));
+   qns.addSystemClass(initDigestClass(qns));
 
 #ifdef DEBUG_TESTS
    { // tests
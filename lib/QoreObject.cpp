@@ -35,6 +35,8 @@
 #include <qore/intern/QoreObjectIntern.h>
 #include <qore/intern/QoreHashNodeIntern.h>
 
+ObjectLockStripe qore_object_lock_stripes[QORE_OBJECT_LOCK_STRIPES];
+
 qore_object_private::qore_object_private(QoreObject* n_obj, const QoreClass* oc, QoreProgram* p, QoreHashNode* n_data) :
    theclass(oc), status(OS_OK),
    privateData(0), data(n_data), pgm(p), system_object(!p),
@@ -56,6 +58,9 @@ qore_object_private::qore_object_private(QoreObject* n_obj, const QoreClass* oc,
       printd(5, "qore_object_private::qore_object_private() obj: %p (%s) calling QoreProgram::ref() (%p)\n", obj, theclass->getName(), p);
       // make a weak reference to the Program - a strong reference (QoreProgram::ref()) could cause a recursive reference
       p->depRef();
+      // objects are often only used in the thread that created them, which can read members without locking until
+      // another thread locks the object for writing
+      rml.setBias();
    }
 #ifdef DEBUG
    n_data->priv->is_obj = true;
@@ -215,6 +220,10 @@ int qore_object_private::getLValue(const char* key, LValueHelper& lvh, bool inte
    if (checkMemberAccessGetTypeInfo(xsink, key, mti, !internal))
       return -1;
 
+   return getSlotLValue(key, qore_hash_private::npos, mti, lvh, for_remove, xsink);
+}
+
+int qore_object_private::getSlotLValue(const char* key, size_t slot, const QoreTypeInfo* mti, LValueHelper& lvh, bool for_remove, ExceptionSink* xsink) const {
    // do lock handoff
    AutoVLock& vl = lvh.getAutoVLock();
    qore_object_lock_handoff_helper qolhm(const_cast<qore_object_private*>(this), vl);
@@ -230,18 +239,37 @@ int qore_object_private::getLValue(const char* key, LValueHelper& lvh, bool inte
    // save lvalue type info
    lvh.setTypeInfo(mti);
 
-   HashMember* m;
-   if (for_remove) {
-      m = data->priv->findMember(key);
-      if (!m)
+   qore_hash_private& h = *data->priv;
+   size_t i = h.findSlot(key, slot);
+   if (i == qore_hash_private::npos) {
+      if (for_remove)
          return -1;
+      i = h.findCreate(key);
    }
-   else
-      m = data->priv->findCreateMember(key);
-   lvh.setPtr(m->node);
+   lvh.setPtr(h.getValueRef(i));
    return 0;
 }
 
+AbstractQoreNode* qore_object_private::getReferencedSlotMember(const char* mem, size_t slot, ExceptionSink* xsink) const {
+   QoreSafeVarRWReadLocker sl(rml);
+
+   if (status == OS_DELETED) {
+      makeAccessDeletedObjectException(xsink, mem, theclass->getName());
+      return 0;
+   }
+
+   const qore_hash_private& h = *data->priv;
+   size_t i = h.findSlot(mem, slot);
+   if (i == qore_hash_private::npos)
+      return 0;
+   AbstractQoreNode* v = h.getValue(i);
+   return v ? v->refSelf() : 0;
+}
+
+void qore_object_private::setMemberKeys(QoreObject& obj, qore_hash_keys* kt) {
+   obj.priv->data->priv->setKeys(kt);
+}
+
 // helper function for QoreObject::evalBuiltinMethodWithPrivateData() variations
 static void check_meth_eval(const QoreClass* cls, const char* mname, const QoreClass* mclass, ExceptionSink* xsink) {
    if (!xsink->isException()) {
@@ -561,7 +589,7 @@ void QoreObject::customRefIntern() const {
 }
 
 void QoreObject::customRef() const {
-   AutoLocker al(priv->ref_mutex);
+   AutoLocker al(priv->refMutex());
    customRefIntern();
 }
 
@@ -569,7 +597,7 @@ void QoreObject::deleteBlockerRef() const {
 #ifdef QORE_DEBUG_OBJ_REFS
    printd(QORE_DEBUG_OBJ_REFS, "QoreObject::deleteBlockerRef() this: %p '%s' references %d->%d\n", this, getClassName(), references, references + 1);
 #endif
-   AutoLocker al(priv->ref_mutex);
+   AutoLocker al(priv->refMutex());
    ++references;
 }
 
@@ -590,7 +618,7 @@ void QoreObject::customDeref(ExceptionSink* xsink) {
 
       int ref_copy;
       {
-	 AutoLocker slr(priv->ref_mutex);
+	 AutoLocker slr(priv->refMutex());
 	 ref_copy = --references;
       }
 
@@ -1488,20 +1516,23 @@ public:
    int rcycle;
 
    DLLLOCAL ObjectRScanHelper(qore_object_private& o) : obj(o), rcycle(o.rcycle) {
-      AutoLocker al(obj.rlck);
+      ObjectLockStripe& s = obj.getStripe();
+      AutoLocker al(s.l);
       while (obj.rscan) {
 	 ++obj.rwaiting;
-	 obj.rdone.wait(obj.rlck);
+	 s.c.wait(s.l);
 	 --obj.rwaiting;
       }
       obj.rscan = gettid();
    }
 
    DLLLOCAL ~ObjectRScanHelper() {
-      AutoLocker al(obj.rlck);
+      ObjectLockStripe& s = obj.getStripe();
+      AutoLocker al(s.l);
       assert(obj.rscan == gettid());
+      // the condition is shared with other objects, so all waiting threads must be woken up
       if (obj.rwaiting)
-	 obj.rdone.signal();
+	 s.c.broadcast();
       obj.rscan = 0;
    }
 
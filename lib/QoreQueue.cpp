@@ -47,10 +47,18 @@ void qore_queue_private::destructor(ExceptionSink* xsink) {
    }
 
    clearIntern(xsink);
-   len = Queue_Deleted;
+   // ring-buffer queues check the deleted status without the lock
+   qore_atomic_store_release(&len, (int)Queue_Deleted);
 }
 
 void qore_queue_private::clearIntern(ExceptionSink* xsink) {
+   if (ring) {
+      AbstractQoreNode* v;
+      while (ring->tryShift(v))
+         discard(v, xsink);
+      return;
+   }
+
    while (head) {
       printd(5, "qore_queue_private::clearIntern() this: %p deleting %p (node %p type %s)\n", this, head, head->node, get_node_type(head->node));
       QoreQueueNode* w = head->next;
@@ -113,6 +121,241 @@ int qore_queue_private::waitWriteIntern(ExceptionSink *xsink, int timeout_ms) {
    return 0;
 }
 
+// called with the lock held; the waiting count is updated with a full barrier before the ring buffer is checked
+// so that producers that do not see a waiting thread are guaranteed to have published their value before the check
+int qore_queue_private::waitRingReadIntern(ExceptionSink* xsink, int timeout_ms, AbstractQoreNode*& rv) {
+   while (true) {
+      if (len == Queue_Deleted) {
+         xsink->raiseException("QUEUE-ERROR", "Queue has been deleted in another thread");
+         return QW_DEL;
+      }
+
+      qore_atomic_fetch_add(&read_waiting, 1u);
+      if (ring->tryShift(rv)) {
+         qore_atomic_fetch_sub(&read_waiting, 1u);
+         return 0;
+      }
+      int rc = timeout_ms ? read_cond.wait(l, timeout_ms) : read_cond.wait(l);
+      qore_atomic_fetch_sub(&read_waiting, 1u);
+
+      if (rc) {
+         assert(timeout_ms);
+         assert(rc == ETIMEDOUT);
+         return ring->tryShift(rv) ? 0 : QW_TIMEOUT;
+      }
+   }
+}
+
+// called with the lock held
+int qore_queue_private::waitRingWriteIntern(ExceptionSink* xsink, int timeout_ms, AbstractQoreNode* v) {
+   while (true) {
+      if (len == Queue_Deleted) {
+         xsink->raiseException("QUEUE-ERROR", "Queue has been deleted in another thread");
+         return QW_DEL;
+      }
+
+      qore_atomic_fetch_add(&write_waiting, 1u);
+      if (ring->tryPush(v)) {
+         qore_atomic_fetch_sub(&write_waiting, 1u);
+         return 0;
+      }
+      int rc = timeout_ms ? write_cond.wait(l, timeout_ms) : write_cond.wait(l);
+      qore_atomic_fetch_sub(&write_waiting, 1u);
+
+      if (rc) {
+         assert(timeout_ms);
+         assert(rc == ETIMEDOUT);
+         return ring->tryPush(v) ? 0 : QW_TIMEOUT;
+      }
+   }
+}
+
+void qore_queue_private::ringPush(ExceptionSink* xsink, const AbstractQoreNode* n, int timeout_ms, bool* to) {
+   // values pushed after the queue has been deleted are ignored as with normal queues; values that are pushed
+   // while the queue is being deleted are dereferenced in the destructor
+   if (ringDeleted())
+      return;
+
+   AbstractQoreNode* v = n ? n->refSelf() : 0;
+   // fast path: no locking if there is room in the buffer
+   if (!ring->tryPush(v)) {
+      AutoLocker al(&l);
+      int rc = waitRingWriteIntern(xsink, timeout_ms, v);
+      if (to)
+         *to = rc == QW_TIMEOUT ? true : false;
+      if (rc) {
+         discard(v, xsink);
+         return;
+      }
+   }
+   else if (to)
+      *to = false;
+
+   ringSignalReaders(1);
+}
+
+AbstractQoreNode* qore_queue_private::ringShift(ExceptionSink* xsink, int timeout_ms, bool* to) {
+   AbstractQoreNode* rv;
+   // fast path: no locking if there is data in the buffer
+   if (!ring->tryShift(rv)) {
+      AutoLocker al(&l);
+      int rc = waitRingReadIntern(xsink, timeout_ms, rv);
+      if (to)
+         *to = rc == QW_TIMEOUT ? true : false;
+      if (rc)
+         return 0;
+   }
+   else if (to)
+      *to = false;
+
+   ringSignalWriters(1);
+   return rv;
+}
+
+void qore_queue_private::ringClear(ExceptionSink* xsink) {
+   unsigned cnt = 0;
+   AbstractQoreNode* v;
+   while (ring->tryShift(v)) {
+      discard(v, xsink);
+      ++cnt;
+   }
+
+   if (cnt)
+      ringSignalWriters(cnt);
+}
+
+void qore_queue_private::pushBatch(ExceptionSink* xsink, const QoreListNode* lst, int timeout_ms, bool* to) {
+   if (to)
+      *to = false;
+
+   ConstListIterator li(lst);
+
+   if (ring) {
+      if (ringDeleted())
+         return;
+
+      unsigned pushed = 0;
+      while (li.next()) {
+         AbstractQoreNode* v = li.getValue() ? li.getValue()->refSelf() : 0;
+         if (!ring->tryPush(v)) {
+            // wake up readers before blocking so that the buffer can be drained
+            if (pushed) {
+               ringSignalReaders(pushed);
+               pushed = 0;
+            }
+            AutoLocker al(&l);
+            int rc = waitRingWriteIntern(xsink, timeout_ms, v);
+            if (rc) {
+               if (to)
+                  *to = rc == QW_TIMEOUT ? true : false;
+               discard(v, xsink);
+               return;
+            }
+         }
+         ++pushed;
+      }
+      if (pushed)
+         ringSignalReaders(pushed);
+      return;
+   }
+
+   AutoLocker al(&l);
+   if (len == Queue_Deleted)
+      return;
+
+   unsigned pushed = 0;
+   while (li.next()) {
+      if (max > 0 && len >= max) {
+         // wake up readers before blocking so that the queue can be drained
+         if (pushed && read_waiting) {
+            read_cond.broadcast();
+            pushed = 0;
+         }
+         int rc = waitWriteIntern(xsink, timeout_ms);
+         if (rc) {
+            if (to)
+               *to = rc == QW_TIMEOUT ? true : false;
+            return;
+         }
+      }
+      pushNode(li.getValue() ? li.getValue()->refSelf() : 0);
+      ++pushed;
+   }
+
+   // signal waiting threads only once for the entire batch
+   if (pushed && read_waiting) {
+      if (pushed == 1)
+         read_cond.signal();
+      else
+         read_cond.broadcast();
+   }
+}
+
+QoreListNode* qore_queue_private::getBatch(ExceptionSink* xsink, int n_max, int timeout_ms, bool* to) {
+   if (ring) {
+      AbstractQoreNode* v;
+      if (!ring->tryShift(v)) {
+         AutoLocker al(&l);
+         int rc = waitRingReadIntern(xsink, timeout_ms, v);
+         if (to)
+            *to = rc == QW_TIMEOUT ? true : false;
+         if (rc)
+            return 0;
+      }
+      else if (to)
+         *to = false;
+
+      QoreListNode* rv = new QoreListNode;
+      rv->push(v);
+      while ((n_max <= 0 || (int)rv->size() < n_max) && ring->tryShift(v))
+         rv->push(v);
+
+      ringSignalWriters(rv->size());
+      return rv;
+   }
+
+   SafeLocker sl(&l);
+   {
+      int rc = waitReadIntern(xsink, timeout_ms);
+      if (to)
+         *to = rc == QW_TIMEOUT ? true : false;
+      if (rc)
+         return 0;
+   }
+
+   // detach the nodes in the lock and free them afterwards
+   QoreQueueNode* first = head;
+   QoreQueueNode* last = head;
+   int cnt = 1;
+   while (last->next && (n_max <= 0 || cnt < n_max)) {
+      last = last->next;
+      ++cnt;
+   }
+   head = last->next;
+   if (!head)
+      tail = 0;
+   else
+      head->prev = 0;
+
+   len -= cnt;
+   if (write_waiting) {
+      if (cnt == 1)
+         write_cond.signal();
+      else
+         write_cond.broadcast();
+   }
+
+   sl.unlock();
+
+   QoreListNode* rv = new QoreListNode;
+   while (cnt--) {
+      QoreQueueNode* w = first->next;
+      rv->push(first->takeAndDel());
+      first = w;
+   }
+   return rv;
+}
+
 void qore_queue_private::pushNode(AbstractQoreNode* v) {
    if (!head) {
       head = new QoreQueueNode(v, 0, 0);
@@ -169,6 +412,11 @@ void qore_queue_private::pushAndTakeRef(AbstractQoreNode* n) {
 }
 
 void qore_queue_private::push(ExceptionSink* xsink, const AbstractQoreNode* n, int timeout_ms, bool* to) {
+   if (ring) {
+      ringPush(xsink, n, timeout_ms, to);
+      return;
+   }
+
    AutoLocker al(&l);
    if (len == Queue_Deleted)
       return;
@@ -185,6 +433,12 @@ void qore_queue_private::push(ExceptionSink* xsink, const AbstractQoreNode* n, i
 }
 
 void qore_queue_private::insert(ExceptionSink* xsink, const AbstractQoreNode* n, int timeout_ms, bool* to) {
+   if (checkRingOp(xsink, "insert")) {
+      if (to)
+         *to = false;
+      return;
+   }
+
    AutoLocker al(&l);
    if (len == Queue_Deleted)
       return;
@@ -201,6 +455,9 @@ void qore_queue_private::insert(ExceptionSink* xsink, const AbstractQoreNode* n,
 }
 
 AbstractQoreNode* qore_queue_private::shift(ExceptionSink* xsink, int timeout_ms, bool* to) {
+   if (ring)
+      return ringShift(xsink, timeout_ms, to);
+
    SafeLocker sl(&l);
 
 #ifdef DEBUG
@@ -233,6 +490,12 @@ AbstractQoreNode* qore_queue_private::shift(ExceptionSink* xsink, int timeout_ms
 }
 
 AbstractQoreNode* qore_queue_private::pop(ExceptionSink* xsink, int timeout_ms, bool* to) {
+   if (checkRingOp(xsink, "pop")) {
+      if (to)
+         *to = false;
+      return 0;
+   }
+
    SafeLocker sl(&l);
 
    {
@@ -259,6 +522,11 @@ AbstractQoreNode* qore_queue_private::pop(ExceptionSink* xsink, int timeout_ms,
 }
 
 void qore_queue_private::clear(ExceptionSink* xsink) {
+   if (ring) {
+      ringClear(xsink);
+      return;
+   }
+
    AutoLocker al(&l);
    if (read_waiting) {
       // the queue must be empty
@@ -84,3 +84,19 @@ bool QoreReferenceCounter::ROdereference() const {
    return !rc;
 #endif
 }
+
+#ifndef HAVE_QORE_ATOMIC_BUILTINS
+// number of locks used for the atomic operations in qore_atomic.h on platforms without atomic builtins
+#define QORE_ATOMIC_LOCKS 64
+
+static QoreThreadLock qore_atomic_locks[QORE_ATOMIC_LOCKS];
+static QoreThreadLock qore_atomic_fence_lock;
+
+QoreThreadLock& qore_atomic_lock(const volatile void* p) {
+   return qore_atomic_locks[((size_t)p >> 4) % QORE_ATOMIC_LOCKS];
+}
+
+void qore_atomic_fence() {
+   AutoLocker al(qore_atomic_fence_lock);
+}
+#endif
@@ -141,6 +141,9 @@ void QoreSQLStatement::deref(ExceptionSink* xsink) {
       if (prepare_args)
          prepare_args->deref(xsink);
 
+      if (row_keys)
+         row_keys->deref(xsink);
+
       delete this;
    }
 }
@@ -343,7 +346,20 @@ QoreHashNode* QoreSQLStatement::fetchRow(ExceptionSink* xsink) {
    if (checkStatus(xsink, dba, STMT_DEFINED, "fetchRow"))
       return 0;
 
-   return qore_dbi_private::get(*priv->ds->getDriver())->stmt_fetch_row(this, xsink);
+   QoreHashNode* rv = qore_dbi_private::get(*priv->ds->getDriver())->stmt_fetch_row(this, xsink);
+   if (rv)
+      shareRowKeys(*rv, xsink);
+   return rv;
+}
+
+// makes rows with the same columns as the last row fetched share one key table
+void QoreSQLStatement::shareRowKeys(QoreHashNode& row, ExceptionSink* xsink) {
+   if (row_keys && qore_hash_private::shareKeys(row, *row_keys))
+      return;
+
+   if (row_keys)
+      row_keys->deref(xsink);
+   row_keys = row.copyKeys();
 }
 
 QoreListNode* QoreSQLStatement::fetchRows(int rows, ExceptionSink* xsink) {
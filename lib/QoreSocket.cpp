@@ -36,6 +36,8 @@
 #include <qore/QoreSocket.h>
 
 #include <qore/intern/qore_socket_private.h>
+#include <qore/intern/qore_qf_private.h>
+#include <qore/intern/QC_Compressor.h>
 
 void se_in_op(const char* meth, ExceptionSink* xsink) {
    assert(xsink);
@@ -247,6 +249,307 @@ void concat_target(QoreString& str, const struct sockaddr *addr, const char* typ
       str.sprintf(" (%s: %s:%d)", type, host.getBuffer(), q_get_port_from_addr(addr));
 }
 
+int qore_socket_private::waitForData(const std::vector<int>& socks, std::vector<bool>& ready, int timeout_ms, const char* mname, ExceptionSink* xsink) {
+   assert(socks.size() == ready.size());
+
+   // do not wait if any socket already has buffered data
+   int nready = 0;
+   for (unsigned i = 0; i < ready.size(); ++i) {
+      if (ready[i])
+         ++nready;
+   }
+   if (nready)
+      timeout_ms = 0;
+
+   int rc;
+#ifdef HAVE_POLL_H
+   std::vector<struct pollfd> pfd(socks.size());
+   for (unsigned i = 0; i < socks.size(); ++i) {
+      // negative descriptors are ignored by poll()
+      pfd[i].fd = ready[i] ? -1 : socks[i];
+      pfd[i].events = POLLIN;
+      pfd[i].revents = 0;
+   }
+
+   while (true) {
+      rc = ::poll(pfd.empty() ? 0 : &pfd[0], pfd.size(), timeout_ms);
+      if (rc != QORE_SOCKET_ERROR || sock_get_error() != EINTR)
+         break;
+   }
+   if (rc == QORE_SOCKET_ERROR) {
+      qore_socket_error(xsink, "SOCKET-SELECT-ERROR", "error waiting for socket I/O", mname);
+      return -1;
+   }
+
+   for (unsigned i = 0; i < pfd.size(); ++i) {
+      if (!pfd[i].revents)
+         continue;
+      if (pfd[i].revents & POLLNVAL) {
+         xsink->raiseException("SOCKET-CLOSED", "error while executing Socket::%s(): socket %d in the list was closed while waiting", mname, i);
+         return -1;
+      }
+      ready[i] = true;
+      ++nready;
+   }
+#else
+   // on Windows an fd_set is an array of socket handles, so the limit is on the number of sockets, not on their values
+   if (socks.size() > FD_SETSIZE) {
+      xsink->raiseException("SOCKET-SELECT-ERROR", "error while executing Socket::%s(): cannot wait on more than %d sockets on this platform (%d given)", mname, FD_SETSIZE, (int)socks.size());
+      return -1;
+   }
+
+   fd_set sfs;
+   int maxfd = -1;
+   struct timeval tv;
+   while (true) {
+      FD_ZERO(&sfs);
+      for (unsigned i = 0; i < socks.size(); ++i) {
+         if (!ready[i]) {
+            FD_SET(socks[i], &sfs);
+            if (socks[i] > maxfd)
+               maxfd = socks[i];
+         }
+      }
+
+      struct timeval* tvp = 0;
+      if (timeout_ms >= 0) {
+         tv.tv_sec  = timeout_ms / 1000;
+         tv.tv_usec = (timeout_ms % 1000) * 1000;
+         tvp = &tv;
+      }
+
+      rc = ::select(maxfd + 1, &sfs, 0, 0, tvp);
+      if (rc != QORE_SOCKET_ERROR || sock_get_error() != EINTR)
+         break;
+   }
+   if (rc == QORE_SOCKET_ERROR) {
+      qore_socket_error(xsink, "SOCKET-SELECT-ERROR", "error waiting for socket I/O", mname);
+      return -1;
+   }
+
+   for (unsigned i = 0; i < socks.size(); ++i) {
+      if (!ready[i] && FD_ISSET(socks[i], &sfs)) {
+         ready[i] = true;
+         ++nready;
+      }
+   }
+#endif
+
+   return nready;
+}
+
+int64 qore_socket_private::sendFileData(ExceptionSink* xsink, const char* mname, qore_qf_private& f, int64 size, int timeout_ms) {
+   int64 total = 0;
+
+   // move the file position back to the logical read position; if this is not possible, send the buffered data first
+   if (f.discardReadBuffer()) {
+      qore_size_t av = f.rbuf_len - f.rbuf_pos;
+      if (size >= 0 && (int64)av > size)
+         av = size;
+      if (send(xsink, mname, f.rbuf + f.rbuf_pos, av, timeout_ms))
+         return -1;
+      f.rbuf_pos += av;
+      total = av;
+      if (size >= 0) {
+         size -= av;
+         if (!size)
+            return total;
+      }
+   }
+
+   int64 rc = sendFile(xsink, mname, f.fd, size, timeout_ms);
+   return rc < 0 ? rc : total + rc;
+}
+
+int64 qore_socket_private::sendFile(ExceptionSink* xsink, const char* mname, QoreFile& file, int64 size, int timeout_ms) {
+   qore_qf_private* f = qore_qf_private::get(file);
+   AutoLocker al(f->m);
+   if (f->check_open(xsink))
+      return -1;
+
+   return sendFileData(xsink, mname, *f, size, timeout_ms);
+}
+
+int qore_socket_private::sendHttpResponseFile(ExceptionSink* xsink, int code, const char* desc, const char* http_version, const QoreHashNode* headers, QoreFile& file, int64 size, int source, int timeout_ms) {
+   qore_qf_private* f = qore_qf_private::get(file);
+   AutoLocker al(f->m);
+   if (f->check_open(xsink))
+      return -1;
+
+   // the message body is sent with a Content-Length header, so the size must be known in advance
+   if (size < 0) {
+      struct stat sbuf;
+      if (fstat(f->fd, &sbuf)) {
+         xsink->raiseErrnoException("SOCKET-SENDHTTPRESPONSE-ERROR", errno, "fstat() call failed");
+         return -1;
+      }
+      if (!S_ISREG(sbuf.st_mode)) {
+         xsink->raiseException("SOCKET-SENDHTTPRESPONSE-ERROR", "the message body size must be given when sending data from a file that is not a regular file");
+         return -1;
+      }
+      qore_offset_t pos = lseek(f->fd, 0, SEEK_CUR);
+      if (pos < 0) {
+         xsink->raiseErrnoException("SOCKET-SENDHTTPRESPONSE-ERROR", errno, "lseek() call failed");
+         return -1;
+      }
+      // take into account any data still in the read buffer
+      pos -= f->rbuf_len - f->rbuf_pos;
+      size = sbuf.st_size > pos ? sbuf.st_size - pos : 0;
+   }
+
+   // prepare header string
+   QoreString hdr(enc);
+
+   hdr.sprintf("HTTP/%s %03d %s", http_version, code, desc);
+
+   do_send_http_message(hdr, headers, source);
+
+   hdr.concat("\r\n");
+
+   do_headers(hdr, headers, size, true);
+
+   int rc;
+   if ((rc = send(xsink, "sendHTTPResponse", hdr.getBuffer(), hdr.strlen(), timeout_ms)))
+      return rc;
+
+   if (!size)
+      return 0;
+
+   int64 brc = sendFileData(xsink, "sendHTTPResponse", *f, size, timeout_ms);
+   return brc < 0 ? (int)brc : 0;
+}
+
+QoreHashNode* qore_socket_private::readHttpBody(AbstractCompressionSink& sink, bool chunked, qore_offset_t len, int timeout, ExceptionSink* xsink, int source) {
+   const char* meth = chunked ? "readHTTPChunkedBody" : "recv";
+
+   if (sock == QORE_INVALID_SOCKET) {
+      se_not_open(meth, xsink);
+      return 0;
+   }
+   if (in_op) {
+      se_in_op(meth, xsink);
+      return 0;
+   }
+
+   // reset "expecting HTTP chunked body" flag
+   if (http_exp_chunked_body)
+      http_exp_chunked_body = false;
+
+   qore_socket_op_helper oh(this);
+
+   char* buf;
+   qore_offset_t rc;
+
+   if (!chunked) {
+      PrivateQoreSocketThroughputHelper th(this, false);
+
+      qore_offset_t br = 0; // bytes received
+      while (len < 0 || br < len) {
+         qore_size_t bs = (len >= 0 && len - br < (qore_offset_t)rbufsize) ? (qore_size_t)(len - br) : rbufsize;
+         rc = brecv(xsink, meth, buf, bs, 0, timeout);
+         if (rc <= 0)
+            break;
+         if (sink.write(buf, rc, xsink))
+            return 0;
+         br += rc;
+      }
+
+      th.finalize(br);
+      return 0;
+   }
+
+   QoreString str; // for reading the size of each chunk
+   while (true) {
+      // state = 0, nothing
+      // state = 1, \r received
+      int state = 0;
+      while (true) {
+         rc = brecv(xsink, meth, buf, 1, 0, timeout, false);
+         if (rc <= 0) {
+            if (!*xsink) {
+               assert(!rc);
+               se_closed(meth, xsink);
+            }
+            return 0;
+         }
+
+         char c = buf[0];
+
+         if (!state && c == '\r')
+            state = 1;
+         else if (state && c == '\n')
+            break;
+         else {
+            if (state) {
+               state = 0;
+               str.concat('\r');
+            }
+            str.concat(c);
+         }
+      }
+
+      // terminate string at ';' char if present
+      char* p = (char*)strchr(str.getBuffer(), ';');
+      if (p)
+         *p = '\0';
+      long size = strtol(str.getBuffer(), 0, 16);
+      do_chunked_read(QORE_EVENT_HTTP_CHUNK_SIZE, size, str.strlen(), source);
+
+      if (!size)
+         break;
+
+      if (size < 0) {
+         xsink->raiseException("READ-HTTP-CHUNK-ERROR", "negative value given for chunk size (%ld)", size);
+         return 0;
+      }
+
+      // the chunk data is passed to the sink without being copied
+      qore_offset_t br = 0; // bytes received
+      while (br < size) {
+         qore_size_t bs = size - br < (qore_offset_t)rbufsize ? (qore_size_t)(size - br) : rbufsize;
+         rc = brecv(xsink, meth, buf, bs, 0, timeout, false);
+         if (rc <= 0) {
+            if (!*xsink) {
+               assert(!rc);
+               se_closed(meth, xsink);
+            }
+            return 0;
+         }
+         if (sink.write(buf, rc, xsink))
+            return 0;
+         br += rc;
+      }
+
+      // read crlf after chunk
+      br = 0;
+      while (br < 2) {
+         rc = brecv(xsink, meth, buf, 2 - br, 0, timeout, false);
+         if (rc <= 0) {
+            if (!*xsink) {
+               assert(!rc);
+               se_closed(meth, xsink);
+            }
+            return 0;
+         }
+         br += rc;
+      }
+
+      do_chunked_read(QORE_EVENT_HTTP_CHUNKED_DATA_RECEIVED, size, size + 2, source);
+
+      str.clear();
+   }
+
+   // read footers or nothing
+   QoreStringNodeHolder hdr(readHTTPData(xsink, meth, timeout, rc, true));
+   if (*xsink || !hdr || (hdr->strlen() >= 2 && hdr->strlen() <= 4))
+      return 0;
+
+   ReferenceHolder<QoreHashNode> h(new QoreHashNode, xsink);
+   convertHeaderToHash(*h, (char*)hdr->getBuffer());
+   do_read_http_header(QORE_EVENT_HTTP_FOOTERS_RECEIVED, *h, source);
+   return h.release();
+}
+
 qore_socket_op_helper::qore_socket_op_helper(qore_socket_private* sock) : s(sock) {
    s->in_op = true;
 }
@@ -1215,42 +1518,12 @@ int QoreSocket::send(int fd, qore_offset_t size) {
       return -1;
    }
 
-   char* buf = (char*)malloc(sizeof(char) * DEFAULT_SOCKET_BUFSIZE);
-
-   qore_offset_t rc = 0;
-   qore_size_t bs = 0;
-   while (true) {
-      // calculate bytes needed
-      qore_size_t bn;
-      if (size < 0)
-	 bn = DEFAULT_SOCKET_BUFSIZE;
-      else {
-	 bn = size - bs;
-	 if (bn > DEFAULT_SOCKET_BUFSIZE)
-	    bn = DEFAULT_SOCKET_BUFSIZE;
-      }
-      rc = read(fd, buf, bn);
-      if (!rc)
-	 break;
-      if (rc < 0) {
-	 printd(5, "QoreSocket::send() read error: %s\n", strerror(errno));
-	 break;
-      }
+   int64 rc = priv->sendFile(0, "send", fd, size);
+   return rc < 0 ? (int)rc : 0;
+}
 
-      // send buffer
-      int src = priv->send(0, "send", buf, rc);
-      if (src < 0) {
-	 printd(5, "QoreSocket::send() send error: %s\n", strerror(errno));
-	 break;
-      }
-      bs += rc;
-      if (size > 0 && bs >= (qore_size_t)size) {
-	 rc = 0;
-	 break;
-      }
-   }
-   free(buf);
-   return rc;
+int64 QoreSocket::sendFile(QoreFile& file, int64 size, int timeout_ms, ExceptionSink* xsink) {
+   return priv->sendFile(xsink, "sendFile", file, size, timeout_ms);
 }
 
 BinaryNode* QoreSocket::recvBinary(qore_offset_t bufsize, int timeout, int *rc) {
@@ -1323,13 +1596,13 @@ int QoreSocket::recv(int fd, qore_offset_t size, int timeout) {
    qore_offset_t rc;
    while (true) {
       // calculate bytes needed
-      int bn;
+      qore_size_t bn;
       if (size == -1)
-	 bn = DEFAULT_SOCKET_BUFSIZE;
+	 bn = priv->rbufsize;
       else {
 	 bn = size - br;
-	 if (bn > DEFAULT_SOCKET_BUFSIZE)
-	    bn = DEFAULT_SOCKET_BUFSIZE;
+	 if (bn > priv->rbufsize)
+	    bn = priv->rbufsize;
       }
 
       rc = priv->brecv(0, "recv", buf, bn, 0, timeout);
@@ -1385,6 +1658,10 @@ int QoreSocket::sendHTTPResponse(ExceptionSink* xsink, int code, const char* des
    return priv->sendHttpResponse(xsink, code, desc, http_version, headers, data, size, 0, source, timeout_ms);
 }
 
+int QoreSocket::sendHTTPResponse(ExceptionSink* xsink, int code, const char* desc, const char* http_version, const QoreHashNode* headers, QoreFile& file, int64 size, int source, int timeout_ms) {
+   return priv->sendHttpResponseFile(xsink, code, desc, http_version, headers, file, size, source, timeout_ms);
+}
+
 int QoreSocket::sendHTTPResponseWithCallback(ExceptionSink* xsink, int code, const char *desc, const char *http_version, const QoreHashNode *headers, const ResolvedCallReferenceNode& send_callback, int source, int timeout_ms) {
    return priv->sendHttpResponse(xsink, code, desc, http_version, headers, 0, 0, &send_callback, source, timeout_ms);
 }
@@ -1793,6 +2070,14 @@ QoreHashNode* QoreSocket::getUsageInfo() const {
    return priv->getUsageInfo();
 }
 
+int QoreSocket::setReadBufferSize(qore_size_t size, ExceptionSink* xsink) {
+   return priv->setReadBufferSize(size, xsink);
+}
+
+qore_size_t QoreSocket::getReadBufferSize() const {
+   return priv->getReadBufferSize();
+}
+
 void QoreSocket::clearStats() {
    priv->clearStats();
 }
@@ -155,6 +155,11 @@ int QoreSocketObject::send(int fd, int size) {
    return priv->socket->send(fd, size);
 }
 
+int64 QoreSocketObject::sendFile(QoreFile& file, int64 size, int timeout_ms, ExceptionSink* xsink) {
+   AutoLocker al(priv->m);
+   return priv->socket->sendFile(file, size, timeout_ms, xsink);
+}
+
 // send bytes and convert to network order
 int QoreSocketObject::sendi1(char b, int timeout_ms, ExceptionSink* xsink) {
    AutoLocker al(priv->m);
@@ -305,6 +310,11 @@ int QoreSocketObject::sendHTTPResponse(ExceptionSink* xsink, int code, const cha
    return priv->socket->sendHTTPResponse(xsink, code, desc, http_version, headers, ptr, size, source, timeout_ms);
 }
 
+int QoreSocketObject::sendHTTPResponse(ExceptionSink* xsink, int code, const char* desc, const char* http_version, const QoreHashNode* headers, QoreFile& file, int64 size, int source, int timeout_ms) {
+   AutoLocker al(priv->m);
+   return priv->socket->sendHTTPResponse(xsink, code, desc, http_version, headers, file, size, source, timeout_ms);
+}
+
 int QoreSocketObject::sendHTTPResponseWithCallback(ExceptionSink* xsink, int code, const char* desc, const char* http_version, const QoreHashNode* headers, const ResolvedCallReferenceNode& send_callback, int source, int timeout_ms) {
    AutoLocker al(priv->m);
    return priv->socket->priv->sendHttpResponse(xsink, code, desc, http_version, headers, 0, 0, &send_callback, source, timeout_ms, &priv->m);
@@ -574,6 +584,16 @@ QoreHashNode* QoreSocketObject::getUsageInfo() const {
    return priv->socket->getUsageInfo();
 }
 
+int QoreSocketObject::setReadBufferSize(qore_size_t size, ExceptionSink* xsink) {
+   AutoLocker al(priv->m);
+   return priv->socket->setReadBufferSize(size, xsink);
+}
+
+qore_size_t QoreSocketObject::getReadBufferSize() const {
+   AutoLocker al(priv->m);
+   return priv->socket->getReadBufferSize();
+}
+
 void QoreSocketObject::clearStats() {
    AutoLocker al(priv->m);
    priv->socket->clearStats();
@@ -32,6 +32,7 @@
 
 #include <qore/Qore.h>
 #include <qore/intern/qore_string_private.h>
+#include <qore/intern/QoreCodec.h>
 #include <qore/minitest.hpp>
 
 #include <errno.h>
@@ -1063,7 +1064,7 @@ QoreString::QoreString(const DateTime *d) : priv(new qore_string_private) {
 }
 
 QoreString::QoreString(const BinaryNode *b) : priv(new qore_string_private) {
-   priv->allocated = b->size() + (b->size() * 4) / 10 + 10; // estimate for base64 encoding
+   priv->allocated = q_base64_encoded_size(b->size(), 0) + 1;
    priv->buf = (char*)malloc(sizeof(char) * priv->allocated);
    priv->len = 0;
    priv->charset = QCS_DEFAULT;
@@ -1071,7 +1072,7 @@ QoreString::QoreString(const BinaryNode *b) : priv(new qore_string_private) {
 }
 
 QoreString::QoreString(const BinaryNode *b, qore_size_t maxlinelen) : priv(new qore_string_private) {
-   priv->allocated = b->size() + (b->size() * 4) / 10 + 10; // estimate for base64 encoding
+   priv->allocated = q_base64_encoded_size(b->size(), maxlinelen) + 1;
    priv->buf = (char*)malloc(sizeof(char) * priv->allocated);
    priv->len = 0;
    priv->charset = QCS_DEFAULT;
@@ -1597,70 +1598,47 @@ QoreString* QoreString::convertEncoding(const QoreEncoding* nccs, ExceptionSink*
    return targ.release();
 }
 
-static void base64_concat(QoreString& str, unsigned char c, qore_size_t& linelen, qore_size_t maxlinelen) {
-   str.concat(table64[c]);
-
-   ++linelen;
-   if (maxlinelen > 0 && linelen == maxlinelen) {
-      str.concat("\r\n");
-      linelen = 0;
-   }
-}
-
 // endian-agnostic binary object -> base64 string function
-// NOTE: not very high-performance - high-performance versions
-//       would likely be endian-aware and operate directly on 32-bit words
 void QoreString::concatBase64(const char* bbuf, qore_size_t size, qore_size_t maxlinelen) {
    //printf("bbuf=%p, size="QSD"\n", bbuf, size);
    if (!size)
       return;
 
-   qore_size_t linelen = 0;
-
-   unsigned char* p = (unsigned char*)bbuf;
-   unsigned char* endbuf = p + size;
-   while (p < endbuf) {
-      // get 6 bits of data
-      unsigned char c = p[0] >> 2;
-
-      // byte 1: concat 1st 6-bit value
-      base64_concat(*this, c, linelen, maxlinelen);
-
-      // byte 1: use remaining 2 bits in low order position
-      c = (p[0] & 3) << 4;
-
-      // check end
-      if ((endbuf - p) == 1) {
-	 base64_concat(*this, c, linelen, maxlinelen);
-	 concat("==");
-	 break;
+   // the output is written directly to the buffer, which is allocated once
+   qore_size_t elen = q_base64_encoded_size(size, maxlinelen);
+   priv->check_char(priv->len + elen);
+   char* p = priv->buf + priv->len;
+   const unsigned char* src = (const unsigned char*)bbuf;
+
+   // number of complete lines; CRLF is added after every maxlinelen encoded characters not counting padding
+   qore_size_t lines = maxlinelen > 0 ? (size * 4 + 2) / 3 / maxlinelen : 0;
+   if (!lines)
+      q_base64_encode(p, src, size);
+   else if (!(maxlinelen % 4)) {
+      // lines hold complete groups of 4 characters, so each line is encoded directly in place
+      qore_size_t lbytes = (maxlinelen / 4) * 3;
+      for (qore_size_t i = 0; i < lines; ++i, src += lbytes, p += maxlinelen + 2) {
+         q_base64_encode(p, src, lbytes);
+         p[maxlinelen] = '\r';
+         p[maxlinelen + 1] = '\n';
       }
-
-      // byte 2: get 4 bits to make next 6-bit unit
-      c |= p[1] >> 4;
-
-      // concat 2nd 6-bit value
-      base64_concat(*this, c, linelen, maxlinelen);
-
-      // byte 2: get 4 low bits
-      c = (p[1] & 15) << 2;
-
-      if ((endbuf - p) == 2) {
-	 base64_concat(*this, c, linelen, maxlinelen);
-	 concat('=');
-	 break;
+      q_base64_encode(p, src, size - lines * lbytes);
+   }
+   else {
+      // encode without line breaks and move the lines to their final positions starting from the end
+      q_base64_encode(p, src, size);
+      qore_size_t tail = ((size + 2) / 3) * 4 - lines * maxlinelen;
+      memmove(p + lines * (maxlinelen + 2), p + lines * maxlinelen, tail);
+      for (qore_size_t i = lines; i--;) {
+         char* l = p + i * (maxlinelen + 2);
+         memmove(l, p + i * maxlinelen, maxlinelen);
+         l[maxlinelen] = '\r';
+         l[maxlinelen + 1] = '\n';
       }
-
-      // byte 3: get high 2 bits to make next 6-bit unit
-      c |= p[2] >> 6;
-
-      // concat 3rd 6-bit value
-      base64_concat(*this, c, linelen, maxlinelen);
-
-      // byte 3: concat final 6 bits
-      base64_concat(*this, p[2] & 63, linelen, maxlinelen);
-      p += 3;
    }
+
+   priv->len += elen;
+   priv->buf[priv->len] = '\0';
 }
 
 void QoreString::concatBase64(const BinaryNode *b, qore_size_t maxlinelen) {
@@ -1683,22 +1661,15 @@ void QoreString::concatBase64(const char* bbuf, qore_size_t size) {
    concatBase64(bbuf, size, -1);
 }
 
-#define DO_HEX_CHAR(b) ((b) + (((b) > 9) ? 87 : 48))
-
 void QoreString::concatHex(const char* binbuf, qore_size_t size) {
    //printf("priv->buf=%p, size="QSD"\n", binbuf, size);
    if (!size)
       return;
 
-   unsigned char* p = (unsigned char*)binbuf;
-   unsigned char* endbuf = p + size;
-   while (p < endbuf) {
-     char c = (*p & 0xf0) >> 4;
-     concat(DO_HEX_CHAR(c));
-     c = *p & 0x0f;
-     concat(DO_HEX_CHAR(c));
-     p++;
-   }
+   priv->check_char(priv->len + size * 2);
+   q_hex_encode(priv->buf + priv->len, (const unsigned char*)binbuf, size);
+   priv->len += size * 2;
+   priv->buf[priv->len] = '\0';
 }
 
 int QoreString::concatEncode(ExceptionSink* xsink, const QoreString& str, unsigned code) {
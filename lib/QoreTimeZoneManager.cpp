@@ -52,10 +52,11 @@
 
 #include <memory>
 #include <map>
+#include <algorithm>
 
 #define QB(x) ((x) ? "true" : "false")
 
-QoreZoneInfo::QoreZoneInfo(QoreString &root, std::string &n_name, ExceptionSink *xsink) : AbstractQoreZoneInfo(n_name), first_pos(-1), valid(false), std_abbr(0) {
+QoreZoneInfo::QoreZoneInfo(QoreString &root, std::string &n_name, ExceptionSink *xsink) : AbstractQoreZoneInfo(n_name), valid(false), std_abbr(0) {
    printd(5, "QoreZoneInfo::QoreZoneInfo() this: %p root: %s name: %s\n", this, root.getBuffer(), name.c_str());
 
    std::string fn = root.getBuffer();
@@ -124,8 +125,6 @@ QoreZoneInfo::QoreZoneInfo(QoreString &root, std::string &n_name, ExceptionSink
       if (f.readi4(&QoreDSTTransitions[i].time, xsink))
 	 return;
 
-      if (first_pos == -1 && QoreDSTTransitions[i].time >= 0)
-         first_pos = i;
       //printd(5, "QoreZoneInfo::QoreZoneInfo() trans_time[%d]: %u\n", i, QoreDSTTransitions[i].time);
    }
 
@@ -192,6 +191,14 @@ QoreZoneInfo::QoreZoneInfo(QoreString &root, std::string &n_name, ExceptionSink
       }
    }
 
+   // create the compact transition time array for band searches
+   trans_times.reserve(QoreDSTTransitions.size());
+   for (dst_transition_vec_t::const_iterator i = QoreDSTTransitions.begin(), e = QoreDSTTransitions.end(); i != e; ++i)
+      trans_times.push_back(i->time);
+
+   // start with the current band so that the most common lookups are resolved immediately
+   last_band = findBand(time(0));
+
    // read in abbreviation list
    if (f.read(str, tzh_charcnt, xsink))
       return;
@@ -275,9 +282,9 @@ int QoreTimeZoneManager::process(const char *fn) {
 
 const AbstractQoreZoneInfo *QoreTimeZoneManager::processFile(const char *fn, bool use_path, ExceptionSink *xsink) {
 #ifdef _Q_WINDOWS
-   tzmap_t::iterator i = tzmap.find(fn);
-   if (i != tzmap.end())
-      return i->second;
+   AbstractQoreZoneInfo* zi = tzmap.find(fn);
+   if (zi)
+      return zi;
 
    //printd(5, "QoreTimeZoneManager::processFile() %s: loading from registry\n", fn);
 
@@ -288,15 +295,15 @@ const AbstractQoreZoneInfo *QoreTimeZoneManager::processFile(const char *fn, boo
 
    //printd(5, "QoreTimeZoneManager::processFile() %s -> %p\n", name.c_str(), tzi.get());
    QoreWindowsZoneInfo *rv = tzi.release();
-   tzmap[fn] = rv;
+   tzmap.insert(fn, rv);
    ++tzsize;
 
    return rv;
 #else
-   std::string name = !strncmp(root.getBuffer(), fn, root.strlen()) ? fn + root.strlen() + 1 : fn;
-   tzmap_t::iterator i = tzmap.find(name);
-   if (i != tzmap.end())
-      return i->second;
+   std::string name = getRegionKey(fn);
+   AbstractQoreZoneInfo* zi = tzmap.find(name.c_str());
+   if (zi)
+      return zi;
 
    std::auto_ptr<QoreZoneInfo> tzi(new QoreZoneInfo(use_path ? *NullString : root, name, xsink));
    if (!*(tzi.get())) {
@@ -306,7 +313,7 @@ const AbstractQoreZoneInfo *QoreTimeZoneManager::processFile(const char *fn, boo
 
    //printd(5, "QoreTimeZoneManager::processFile() %s -> %p\n", name.c_str(), tzi.get());
    QoreZoneInfo *rv = tzi.release();
-   tzmap[name] = rv;
+   tzmap.insert(name, rv);
    ++tzsize;
 
    return rv;
@@ -328,49 +335,36 @@ int QoreTimeZoneManager::processIntern(const char *fn, ExceptionSink *xsink) {
    return processFile(fn, false, xsink) ? 0 : -1;
 }
 
-int QoreZoneInfo::getUTCOffsetImpl(int64 epoch_offset, bool &is_dst, const char *&zone_name) const {
-   //printf("QoreZoneInfo::getUTCOffsetImpl() epoch_offset: %lld first_pos: %d time: %lld\n", epoch_offset, first_pos, first_pos > 0 ? QoreDSTTransitions[first_pos - 1].time : -1ll);
-   unsigned i = 0;
-   if (first_pos > 0 && epoch_offset >= QoreDSTTransitions[first_pos - 1].time) {
-      i = first_pos - 1;
-      unsigned end = QoreDSTTransitions.size() - 1;
-      while (i < end) {
-         if (QoreDSTTransitions[i].time <= epoch_offset && QoreDSTTransitions[i + 1].time > epoch_offset) {
-            zone_name = QoreDSTTransitions[i].trans->abbr.c_str();
-            is_dst = QoreDSTTransitions[i].trans->isdst;
-
-            //printf("QoreZoneInfo::getUTCOffsetImpl(epoch: %lld) tt[<=]: %d tt[>]: %d zone_name: %s is_dst: %d utcoff: %d\n", epoch_offset, QoreDSTTransitions[i].time, QoreDSTTransitions[i + 1].time, zone_name, is_dst, QoreDSTTransitions[i].trans->utcoff);
-            return QoreDSTTransitions[i].trans->utcoff;
-         }
-         ++i;
-      }
-      // not found, time zone unknown
-      is_dst = false;
-      zone_name = std_abbr;
-
-      //printf("QoreZoneInfo::getUTCOffsetImpl(epoch: %lld) NOT FOUND zone_name: %s is_dst: %d utcoff: %d\n", epoch_offset, zone_name, is_dst, utcoff);
-
-      return utcoff;
-   }
-
-   i = first_pos + 1;
-   while (i > 0) {
-      if (QoreDSTTransitions[i].time > epoch_offset && QoreDSTTransitions[i - 1].time <= epoch_offset) {
-         zone_name = QoreDSTTransitions[i].trans->abbr.c_str();
-         is_dst = QoreDSTTransitions[i].trans->isdst;
+int QoreZoneInfo::findBand(int64 epoch_offset) const {
+   // find the first transition after the given time; the band is the one starting before it
+   trans_time_vec_t::const_iterator i = std::upper_bound(trans_times.begin(), trans_times.end(), epoch_offset);
+   int band = (int)(i - trans_times.begin()) - 1;
+   // times before the first and after the last transition are not in any band
+   return band < (int)trans_times.size() - 1 ? band : -1;
+}
 
-         //printf("QoreZoneInfo::getUTCOffsetImpl(epoch: %lld) i: %d tt[<=]: %d tt[>]: %d zone_name: %s is_dst: %d utcoff: %d\n", epoch_offset, i, QoreDSTTransitions[i].time, QoreDSTTransitions[i + 1].time, zone_name, is_dst, QoreDSTTransitions[i].trans->utcoff);
-         return QoreDSTTransitions[i].trans->utcoff;
+int QoreZoneInfo::getUTCOffsetImpl(int64 epoch_offset, bool &is_dst, const char *&zone_name) const {
+   // check the last band found first; consecutive lookups are normally in the same band
+   int band = last_band;
+   if (band < 0 || epoch_offset < trans_times[band] || epoch_offset >= trans_times[band + 1]) {
+      band = findBand(epoch_offset);
+      if (band < 0) {
+         // not found, time zone unknown
+         is_dst = false;
+         zone_name = std_abbr;
+
+         //printf("QoreZoneInfo::getUTCOffsetImpl(epoch: %lld) NOT FOUND zone_name: %s is_dst: %d utcoff: %d\n", epoch_offset, zone_name, is_dst, utcoff);
+         return utcoff;
       }
-      --i;
+      last_band = band;
    }
-   // not found, time zone unknown
-   is_dst = false;
-   zone_name = std_abbr;
 
-   //printf("QoreZoneInfo::getUTCOffsetImpl(epoch: %lld) NOT FOUND zone_name: %s is_dst: %d utcoff: %d\n", epoch_offset, zone_name, is_dst, utcoff);
+   const QoreTransitionInfo* trans = QoreDSTTransitions[band].trans;
+   zone_name = trans->abbr.c_str();
+   is_dst = trans->isdst;
 
-   return utcoff;
+   //printf("QoreZoneInfo::getUTCOffsetImpl(epoch: %lld) band: %d tt[<=]: %d tt[>]: %d zone_name: %s is_dst: %d utcoff: %d\n", epoch_offset, band, trans_times[band], trans_times[band + 1], zone_name, is_dst, trans->utcoff);
+   return trans->utcoff;
 }
 
 // format: S00[[:]00[[:]00]] (S is + or -)
@@ -508,7 +502,7 @@ int QoreTimeZoneManager::processDir(const char *d, ExceptionSink *xsink) {
 
 int QoreTimeZoneManager::setLocalTZ(std::string fname, AbstractQoreZoneInfo *tzi) {
    localtz = tzi;
-   tzmap[fname] = localtz;
+   tzmap.insert(fname, localtz);
    localtzname = fname;
    ++tzsize;
 
@@ -1475,12 +1469,21 @@ int QoreTimeZoneManager::readAll(ExceptionSink *xsink) {
 }
 
 const AbstractQoreZoneInfo *QoreTimeZoneManager::findLoadRegion(const char *name, ExceptionSink *xsink) {
+   // regions that have already been loaded are found without locking
+   const AbstractQoreZoneInfo* zi = tzmap.find(getRegionKey(name));
+   if (zi)
+      return zi;
+
    QoreAutoRWWriteLocker al(rwl);
    // find or load region
    return processFile(name, false, xsink);
 }
 
 const AbstractQoreZoneInfo *QoreTimeZoneManager::findLoadRegionFromPath(const char *name, ExceptionSink *xsink) {
+   const AbstractQoreZoneInfo* zi = tzmap.find(getRegionKey(name));
+   if (zi)
+      return zi;
+
    QoreAutoRWWriteLocker al(rwl);
    // find or load region
    return processFile(name, true, xsink);
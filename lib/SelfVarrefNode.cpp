@@ -29,6 +29,7 @@
 */
 
 #include <qore/Qore.h>
+#include <qore/intern/QoreObjectIntern.h>
 
 // get string representation (for %n and %N), foff is for multi-line formatting offset, -1 = no line breaks
 // the ExceptionSink is only needed for QoreObject where a method may be executed
@@ -55,7 +56,18 @@ const char *SelfVarrefNode::getTypeName() const {
 QoreValue SelfVarrefNode::evalValueImpl(bool &needs_deref, ExceptionSink *xsink) const {
    assert(runtime_get_stack_object());
    //printd(0, "");
-   return runtime_get_stack_object()->getReferencedMemberNoMethod(str, xsink);
+   return qore_object_private::getReferencedSlotMember(*runtime_get_stack_object(), str, slot, xsink);
+}
+
+int SelfVarrefNode::getLValue(LValueHelper& lvh, bool for_remove) const {
+   // note that getStackObject() is guaranteed to return a value here (self varref is only valid in a method)
+   QoreObject* obj = runtime_get_stack_object();
+   assert(obj);
+   // declared members were already checked at parse time
+   if (slot != (size_t)-1)
+      return qore_object_private::getSlotLValue(*obj, str, slot, returnTypeInfo, lvh, for_remove, lvh.vl.xsink);
+   // true is for "internal"
+   return qore_object_private::getLValue(*obj, str, lvh, true, for_remove, lvh.vl.xsink);
 }
 
 char *SelfVarrefNode::takeString() {
@@ -70,7 +82,8 @@ AbstractQoreNode *SelfVarrefNode::parseInitImpl(LocalVar *oflag, int pflag, int
    if (!oflag)
       parse_error(loc, "cannot reference member \"%s\" when not in an object context", str);
    else {
-      qore_class_private::parseCheckInternalMemberAccess(getParseClass(), str, typeInfo, loc);
+      if (!qore_class_private::parseCheckInternalMemberAccess(getParseClass(), str, typeInfo, loc))
+         slot = qore_class_private::parseGetMemberSlot(getParseClass(), str);
       returnTypeInfo = typeInfo;
    }
 
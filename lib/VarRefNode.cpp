@@ -85,7 +85,7 @@ QoreValue VarRefNode::evalValueImpl(bool& needs_deref, ExceptionSink* xsink) con
    QoreValue v;
    if (type == VT_LOCAL) {
       printd(5, "VarRefNode::evalImpl() this: %p lvar %p (%s)\n", this, ref.id, ref.id->getName());
-      v = ref.id->evalValue(needs_deref, xsink);
+      v = ref.id->evalValue(needs_deref, xsink, lvar_hint);
    }
    else if (type == VT_CLOSURE) {
       printd(5, "VarRefNode::evalImpl() this: %p closure var %p (%s)\n", this, ref.id, ref.id->getName());
@@ -186,7 +186,7 @@ void VarRefNode::makeGlobal() {
 
 int VarRefNode::getLValue(LValueHelper& lvh, bool for_remove) const {
    if (type == VT_LOCAL)
-      return ref.id->getLValue(lvh, for_remove);
+      return ref.id->getLValue(lvh, for_remove, lvar_hint);
    if (type == VT_CLOSURE)
       return thread_get_runtime_closure_var(ref.id)->getLValue(lvh, for_remove);
    if (type == VT_LOCAL_TS)
@@ -199,7 +199,7 @@ int VarRefNode::getLValue(LValueHelper& lvh, bool for_remove) const {
 
 DLLLOCAL void VarRefNode::remove(LValueRemoveHelper& lvrh) {
    if (type == VT_LOCAL)
-      return ref.id->remove(lvrh);
+      return ref.id->remove(lvrh, lvar_hint);
    if (type == VT_CLOSURE)
       return thread_get_runtime_closure_var(ref.id)->remove(lvrh);
    if (type == VT_LOCAL_TS)
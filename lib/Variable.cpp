@@ -434,14 +434,10 @@ int LValueHelper::doLValue(const AbstractQoreNode* n, bool for_remove) {
          return -1;
    }
    else if (ntype == NT_SELF_VARREF) {
-      const SelfVarrefNode* v = reinterpret_cast<const SelfVarrefNode*>(n);
-      // note that getStackObject() is guaranteed to return a value here (self varref is only valid in a method)
-      QoreObject* obj = runtime_get_stack_object();
-      assert(obj);
-      // true is for "internal"
-      if (qore_object_private::getLValue(*obj, v->str, *this, true, for_remove, vl.xsink))
+      if (reinterpret_cast<const SelfVarrefNode*>(n)->getLValue(*this, for_remove))
          return -1;
 
+      QoreObject* obj = runtime_get_stack_object();
       robj = obj;
       ocvec.push_back(ObjCountRec(obj));
    }
@@ -103,6 +103,7 @@
 #include "QoreLib.cpp"
 #include "QoreTimeZoneManager.cpp"
 #include "QoreString.cpp"
+#include "QoreCodec.cpp"
 #include "QoreObject.cpp"
 #include "QoreListNode.cpp"
 #include "QoreValueList.cpp"
@@ -217,6 +218,7 @@
 #include "qc_errno.cpp"
 #include "qc_qore.cpp"
 #include "QC_Socket.cpp"
+#include "QC_SocketPoller.cpp"
 #include "QC_Program.cpp"
 #include "QC_ReadOnlyFile.cpp"
 #include "QC_File.cpp"
@@ -250,6 +252,7 @@
 #include "QC_SingleValueIterator.cpp"
 #include "QC_RangeIterator.cpp"
 #include "QC_ThreadPool.cpp"
+#include "QC_ThreadPoolFuture.cpp"
 #include "QC_AbstractDatasource.cpp"
 #include "QC_Datasource.cpp"
 #include "QC_DatasourcePool.cpp"
@@ -272,6 +275,11 @@
 #include "QC_AbstractSmartLock.cpp"
 #include "QC_TimeZone.cpp"
 #include "QC_TreeMap.cpp"
+#include "QC_ColumnSet.cpp"
+#include "QC_ColumnSetIterator.cpp"
+#include "QC_Compressor.cpp"
+#include "QC_Decompressor.cpp"
+#include "QC_Digest.cpp"
 #include "QC_AbstractThreadResource.cpp"
 
 #include "QorePseudoMethods.cpp"
@@ -99,6 +99,7 @@ QorePThreadAttr ta_default;
 DLLLOCAL QoreThreadList thread_list;
 
 DLLLOCAL QoreClass* initThreadPoolClass(QoreNamespace& ns);
+DLLLOCAL QoreClass* initThreadPoolFutureClass(QoreNamespace& ns);
 
 const qore_class_private* ClassObj::getClass() const {
    if (!ptr)
@@ -348,6 +349,9 @@ public:
    // AbstractQoreModule* with boolean ptr in bit 0
    uintptr_t qmi;
 
+   // call-site variant cache statistics
+   int64 vc_hits, vc_misses;
+
    bool
    foreign : 1; // true if the thread is a foreign thread
 
@@ -358,7 +362,7 @@ public:
       current_pgm(p), current_ns(0), current_implicit_arg(0), tlpd(0), tpd(new ThreadProgramData(this)),
       closure_parse_env(0), closure_rt_env(0),
       returnTypeInfo(0), parse_return_type_info(0), element(0), global_vnode(0), pcs(0),
-      qmc(0), qmd(0), user_module_context_name(0), qmi(0), foreign(n_foreign) {
+      qmc(0), qmd(0), user_module_context_name(0), qmi(0), vc_hits(0), vc_misses(0), foreign(n_foreign) {
 
 #ifdef QORE_MANAGE_STACK
 
@@ -836,11 +840,30 @@ void thread_uninstantiate_self() {
    td->tlpd->lvstack.uninstantiateSelf();
 }
 
+void thread_variant_cache_hit() {
+   ++(thread_data.get()->vc_hits);
+}
+
+void thread_variant_cache_miss() {
+   ++(thread_data.get()->vc_misses);
+}
+
+void thread_get_variant_cache_stats(int64& hits, int64& misses) {
+   ThreadData* td = thread_data.get();
+   hits = td->vc_hits;
+   misses = td->vc_misses;
+}
+
 LocalVarValue* thread_find_lvar(const char* id) {
    ThreadData* td = thread_data.get();
    return td->tlpd->lvstack.find(id);
 }
 
+LocalVarValue* thread_find_lvar(const char* id, int& hint) {
+   ThreadData* td = thread_data.get();
+   return td->tlpd->lvstack.find(id, hint);
+}
+
 ClosureVarValue* thread_instantiate_closure_var(const char* n_id, const QoreTypeInfo* typeInfo, QoreValue& nval) {
    return thread_data.get()->tlpd->cvstack.instantiate(n_id, typeInfo, nval);
 }
@@ -2128,6 +2151,7 @@ QoreNamespace* get_thread_ns(QoreNamespace &qorens) {
    Thread->addSystemClass(initAutoReadLockClass(*Thread));
    Thread->addSystemClass(initAutoWriteLockClass(*Thread));
 
+   Thread->addSystemClass(initThreadPoolFutureClass(*Thread));
    Thread->addSystemClass(initThreadPoolClass(*Thread));
 
    Thread->addSystemClass(initAbstractThreadResourceClass(*Thread));